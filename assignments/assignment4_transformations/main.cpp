@@ -60,10 +60,10 @@ int main() {
 
 	lm::Transform transform[NUM_CUBES];
 
-	transform[0].position = ew::Vec3(-0.5f, 0.5f, 0.0f);
-	transform[1].position = ew::Vec3(0.5f, 0.5f, 0.0f);
-	transform[2].position = ew::Vec3(0.5f, -0.5f, 0.0f);
-	transform[3].position = ew::Vec3(-0.5f, -0.5f, 0.0f);
+	transform[0].setPosition(ew::Vec3(-0.5f, 0.5f, 0.0f));
+	transform[1].setPosition(ew::Vec3(0.5f, 0.5f, 0.0f));
+	transform[2].setPosition(ew::Vec3(0.5f, -0.5f, 0.0f));
+	transform[3].setPosition(ew::Vec3(-0.5f, -0.5f, 0.0f));
 	
 	while (!glfwWindowShouldClose(window)) {
 		glfwPollEvents();
@@ -102,33 +102,42 @@ int main() {
 			{
 				ImGui::PushID(i);
 				if (ImGui::CollapsingHeader("Transform")) {
-					ImGui::DragFloat3("Position", &transform[i].position.x, 0.05f);
-					ImGui::DragFloat3("Rotation", &transform[i].rotation.x, 0.1f);
-					ImGui::DragFloat3("Scale", &transform[i].scale.x, 0.05f);
+					ew::Vec3 position = transform[i].getPosition();
+					if (ImGui::DragFloat3("Position", &position.x, 0.05f)) {
+						transform[i].setPosition(position);
+					}
+					ew::Vec3 rotation = transform[i].getRotation();
+					if (ImGui::DragFloat3("Rotation", &rotation.x, 0.1f)) {
+						transform[i].setRotation(rotation);
+					}
+					ew::Vec3 scale = transform[i].getScale();
+					if (ImGui::DragFloat3("Scale", &scale.x, 0.05f)) {
+						transform[i].setScale(scale);
+					}
 				}
 				if (ImGui::Button("Reset"))
 				{
 					switch (i)
 					{
 					case 0:
-						transform[0].position = ew::Vec3(-0.5f, 0.5f, 0.0f);
-						transform[0].rotation = ew::Vec3(0.0f, 0.0f, 0.0f);
-						transform[0].scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+						transform[0].setPosition(ew::Vec3(-0.5f, 0.5f, 0.0f));
+						transform[0].setRotation(ew::Vec3(0.0f, 0.0f, 0.0f));
+						transform[0].setScale(ew::Vec3(1.0f, 1.0f, 1.0f));
 						break;
 					case 1:
-						transform[1].position = ew::Vec3(0.5f, 0.5f, 0.0f);
-						transform[1].rotation = ew::Vec3(0.0f, 0.0f, 0.0f);
-						transform[1].scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+						transform[1].setPosition(ew::Vec3(0.5f, 0.5f, 0.0f));
+						transform[1].setRotation(ew::Vec3(0.0f, 0.0f, 0.0f));
+						transform[1].setScale(ew::Vec3(1.0f, 1.0f, 1.0f));
 						break;
 					case 2:
-						transform[2].position = ew::Vec3(0.5f, -0.5f, 0.0f);
-						transform[2].rotation = ew::Vec3(0.0f, 0.0f, 0.0f);
-						transform[2].scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+						transform[2].setPosition(ew::Vec3(0.5f, -0.5f, 0.0f));
+						transform[2].setRotation(ew::Vec3(0.0f, 0.0f, 0.0f));
+						transform[2].setScale(ew::Vec3(1.0f, 1.0f, 1.0f));
 						break;
 					case 3:
-						transform[3].position = ew::Vec3(-0.5f, -0.5f, 0.0f);
-						transform[3].rotation = ew::Vec3(0.0f, 0.0f, 0.0f);
-						transform[3].scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+						transform[3].setPosition(ew::Vec3(-0.5f, -0.5f, 0.0f));
+						transform[3].setRotation(ew::Vec3(0.0f, 0.0f, 0.0f));
+						transform[3].setScale(ew::Vec3(1.0f, 1.0f, 1.0f));
 						break;
 					}
 				}
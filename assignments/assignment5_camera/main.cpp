@@ -66,8 +66,7 @@ int main() {
 	//Cube positions
 	for (size_t i = 0; i < NUM_CUBES; i++)
 	{
-		cubeTransforms[i].position.x = i % (NUM_CUBES / 2) - 0.5;
-		cubeTransforms[i].position.y = i / (NUM_CUBES / 2) - 0.5;
+		cubeTransforms[i].setPosition(ew::Vec3(i % (NUM_CUBES / 2) - 0.5, i / (NUM_CUBES / 2) - 0.5, 0.0f));
 	}
 
 	lm::Camera camera;
@@ -126,33 +125,42 @@ int main() {
 			{
 				ImGui::PushID(i);
 				if (ImGui::CollapsingHeader("Transform")) {
-					ImGui::DragFloat3("Position", &cubeTransforms[i].position.x, 0.05f);
-					ImGui::DragFloat3("Rotation", &cubeTransforms[i].rotation.x, 1.0f);
-					ImGui::DragFloat3("Scale", &cubeTransforms[i].scale.x, 0.05f);
+					ew::Vec3 position = cubeTransforms[i].getPosition();
+					if (ImGui::DragFloat3("Position", &position.x, 0.05f)) {
+						cubeTransforms[i].setPosition(position);
+					}
+					ew::Vec3 rotation = cubeTransforms[i].getRotation();
+					if (ImGui::DragFloat3("Rotation", &rotation.x, 1.0f)) {
+						cubeTransforms[i].setRotation(rotation);
+					}
+					ew::Vec3 scale = cubeTransforms[i].getScale();
+					if (ImGui::DragFloat3("Scale", &scale.x, 0.05f)) {
+						cubeTransforms[i].setScale(scale);
+					}
 				}
 				if (ImGui::Button("Reset"))
 				{
 					switch (i)
 					{
 					case 0:
-						cubeTransforms[0].position = ew::Vec3(-0.5f, -0.5f, 0.0f);
-						cubeTransforms[0].rotation = ew::Vec3(0.0f, 0.0f, 0.0f);
-						cubeTransforms[0].scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+						cubeTransforms[0].setPosition(ew::Vec3(-0.5f, -0.5f, 0.0f));
+						cubeTransforms[0].setRotation(ew::Vec3(0.0f, 0.0f, 0.0f));
+						cubeTransforms[0].setScale(ew::Vec3(1.0f, 1.0f, 1.0f));
 						break;
 					case 1:
-						cubeTransforms[1].position = ew::Vec3(0.5f, -0.5f, 0.0f);
-						cubeTransforms[1].rotation = ew::Vec3(0.0f, 0.0f, 0.0f);
-						cubeTransforms[1].scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+						cubeTransforms[1].setPosition(ew::Vec3(0.5f, -0.5f, 0.0f));
+						cubeTransforms[1].setRotation(ew::Vec3(0.0f, 0.0f, 0.0f));
+						cubeTransforms[1].setScale(ew::Vec3(1.0f, 1.0f, 1.0f));
 						break;
 					case 2:
-						cubeTransforms[2].position = ew::Vec3(-0.5f, 0.5f, 0.0f);
-						cubeTransforms[2].rotation = ew::Vec3(0.0f, 0.0f, 0.0f);
-						cubeTransforms[2].scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+						cubeTransforms[2].setPosition(ew::Vec3(-0.5f, 0.5f, 0.0f));
+						cubeTransforms[2].setRotation(ew::Vec3(0.0f, 0.0f, 0.0f));
+						cubeTransforms[2].setScale(ew::Vec3(1.0f, 1.0f, 1.0f));
 						break;
 					case 3:
-						cubeTransforms[3].position = ew::Vec3(0.5f, 0.5f, 0.0f);
-						cubeTransforms[3].rotation = ew::Vec3(0.0f, 0.0f, 0.0f);
-						cubeTransforms[3].scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+						cubeTransforms[3].setPosition(ew::Vec3(0.5f, 0.5f, 0.0f));
+						cubeTransforms[3].setRotation(ew::Vec3(0.0f, 0.0f, 0.0f));
+						cubeTransforms[3].setScale(ew::Vec3(1.0f, 1.0f, 1.0f));
 						break;
 					}
 				}
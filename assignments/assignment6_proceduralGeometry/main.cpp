@@ -14,6 +14,7 @@
 #include <ew/transform.h>
 #include <ew/camera.h>
 #include <ew/cameraController.h>
+#include <ew/meshCache.h>
 
 #include <lm/procGen.h>
 
@@ -85,6 +86,9 @@ int main() {
 	ew::Mesh cubeMesh(cubeMeshData);
 	bool enableCube = true;
 
+	//Shapes below are rebuilt from their settings, but only when a setting changes
+	ew::MeshCache meshCache;
+
 	// Plane defaults
 	bool enablePlane = true;
 	float planeWidth = 0.5f;
@@ -108,11 +112,11 @@ int main() {
 	//Initialize transforms
 	ew::Transform cubeTransform;
 	ew::Transform planeTransform;
-	planeTransform.position = ew::Vec3(0.75f, -0.25f, 0.0f);
+	planeTransform.setPosition(ew::Vec3(0.75f, -0.25f, 0.0f));
 	ew::Transform cylTransform;
-	cylTransform.position = ew::Vec3(-1.0f, 0.0f, 0.0f);
+	cylTransform.setPosition(ew::Vec3(-1.0f, 0.0f, 0.0f));
 	ew::Transform sphereTransform;
-	sphereTransform.position = ew::Vec3(-2.0f, 0.0f, 0.0f);
+	sphereTransform.setPosition(ew::Vec3(-2.0f, 0.0f, 0.0f));
 
 	resetCamera(camera,cameraController);
 
@@ -156,27 +160,21 @@ int main() {
 		//Draw plane
 		if (enablePlane)
 		{
-			if (keepScalePlane)
-			{
-				ew::MeshData planeMeshData = lm::createPlane(planeWidth / planeSubdivisions, planeHeight / planeSubdivisions, planeSubdivisions);
-				ew::Mesh planeMesh(planeMeshData);
-				shader.setMat4("_Model", planeTransform.getModelMatrix());
-				planeMesh.draw((ew::DrawMode)appSettings.drawAsPoints);
-			}
-			else
-			{
-				ew::MeshData planeMeshData = lm::createPlane(planeWidth, planeHeight, planeSubdivisions);
-				ew::Mesh planeMesh(planeMeshData);
-				shader.setMat4("_Model", planeTransform.getModelMatrix());
-				planeMesh.draw((ew::DrawMode)appSettings.drawAsPoints);
-			}
+			float width = keepScalePlane ? planeWidth / planeSubdivisions : planeWidth;
+			float height = keepScalePlane ? planeHeight / planeSubdivisions : planeHeight;
+			const ew::Mesh& planeMesh = meshCache.get({ "lm::createPlane", { width, height }, planeSubdivisions }, [&](ew::MeshData* meshData) {
+				lm::createPlane(width, height, planeSubdivisions, meshData);
+			});
+			shader.setMat4("_Model", planeTransform.getModelMatrix());
+			planeMesh.draw((ew::DrawMode)appSettings.drawAsPoints);
 		}
 
 		// Draw cylinder
 		if (enableCylinder)
 		{
-			ew::MeshData cylMeshData = lm::createCylinder(cylHeight, cylRadius, cylSegments);
-			ew::Mesh cylMesh(cylMeshData);
+			const ew::Mesh& cylMesh = meshCache.get({ "lm::createCylinder", { cylHeight, cylRadius }, cylSegments }, [&](ew::MeshData* meshData) {
+				lm::createCylinder(cylHeight, cylRadius, cylSegments, meshData);
+			});
 			shader.setMat4("_Model", cylTransform.getModelMatrix());
 			cylMesh.draw((ew::DrawMode)appSettings.drawAsPoints);
 		}
@@ -184,8 +182,9 @@ int main() {
 		// Draw sphere
 		if (enableSphere)
 		{
-			ew::MeshData sphereMeshData = lm::createSphere(sphereRadius, sphereSegments);
-			ew::Mesh sphereMesh(sphereMeshData);
+			const ew::Mesh& sphereMesh = meshCache.get({ "lm::createSphere", { sphereRadius }, sphereSegments }, [&](ew::MeshData* meshData) {
+				lm::createSphere(sphereRadius, sphereSegments, meshData);
+			});
 			shader.setMat4("_Model", sphereTransform.getModelMatrix());
 			sphereMesh.draw((ew::DrawMode)appSettings.drawAsPoints);
 		}
@@ -220,7 +219,10 @@ int main() {
 			}
 			if (ImGui::CollapsingHeader("Plane")) {
 				ImGui::Checkbox("Enable Shape", &enablePlane);
-				ImGui::DragFloat3("Position", &planeTransform.position.x, 0.1f);
+				ew::Vec3 position = planeTransform.getPosition();
+				if (ImGui::DragFloat3("Position", &position.x, 0.1f)) {
+					planeTransform.setPosition(position);
+				}
 				ImGui::Checkbox("Uniform Scaling", &uScalePlane);
 				if (uScalePlane)
 				{
@@ -241,12 +243,15 @@ int main() {
 					planeSubdivisions = 1;
 					uScalePlane = false;
 					keepScalePlane = false;
-					planeTransform.position = ew::Vec3(0.75f, -0.25f, 0.0f);
+					planeTransform.setPosition(ew::Vec3(0.75f, -0.25f, 0.0f));
 				}
 			}
 			if (ImGui::CollapsingHeader("Cylinder")) {
 				ImGui::Checkbox("Enable Shape", &enableCylinder); 
-				ImGui::DragFloat3("Position", &cylTransform.position.x, 0.1f);
+				ew::Vec3 position = cylTransform.getPosition();
+				if (ImGui::DragFloat3("Position", &position.x, 0.1f)) {
+					cylTransform.setPosition(position);
+				}
 				ImGui::Checkbox("Uniform Scaling", &uScaleCylinder);
 				if (uScaleCylinder)
 				{
@@ -265,12 +270,15 @@ int main() {
 					cylHeight = 0.5f;
 					cylSegments = 8;
 					uScaleCylinder = false;
-					cylTransform.position = ew::Vec3(-1.0f, 0.0f, 0.0f);
+					cylTransform.setPosition(ew::Vec3(-1.0f, 0.0f, 0.0f));
 				}
 			}
 			if (ImGui::CollapsingHeader("Sphere")) {
 				ImGui::Checkbox("Enable Shape", &enableSphere);
-				ImGui::DragFloat3("Position", &sphereTransform.position.x, 0.1f);
+				ew::Vec3 position = sphereTransform.getPosition();
+				if (ImGui::DragFloat3("Position", &position.x, 0.1f)) {
+					sphereTransform.setPosition(position);
+				}
 				ImGui::DragFloat("Radius", &sphereRadius, 0.05f);
 				ImGui::DragInt("Segments", &sphereSegments, 0.1f);
 				if (ImGui::Button("Reset"))
@@ -278,7 +286,7 @@ int main() {
 					enableSphere = true;
 					sphereRadius = 0.25f;
 					sphereSegments = 8;
-					sphereTransform.position = ew::Vec3(-2.0f, 0.0f, 0.0f);
+					sphereTransform.setPosition(ew::Vec3(-2.0f, 0.0f, 0.0f));
 				}
 			}
 			ImGui::Text("Misc. Settings");
@@ -289,6 +297,7 @@ int main() {
 				ImGui::DragFloat3("Light Rotation", &appSettings.lightRotation.x, 1.0f);
 			}
 			ImGui::Checkbox("Draw as points", &appSettings.drawAsPoints);
+			ImGui::Text("Cached meshes: %d (%.2f MB)", (int)meshCache.getNumMeshes(), meshCache.getMemoryUsage() / (1024.0f * 1024.0f));
 			if (ImGui::Checkbox("Wireframe", &appSettings.wireframe)) {
 				glPolygonMode(GL_FRONT_AND_BACK, appSettings.wireframe ? GL_LINE : GL_FILL);
 			}
@@ -9,13 +9,15 @@ out Surface{
 	vec3 WorldNormal;
 }vs_out;
 
-uniform mat4 _Model;
+uniform mat3x4 _Model; //Affine model matrix, columns are the rows of ew::Affine3x4
+uniform mat3 _NormalMatrix; //Inverse transpose of the model matrix, computed on the CPU
 uniform mat4 _ViewProjection;
 uniform vec3 _WorldNormal;
 
 void main(){
+	vec3 worldPos = vec4(vPos,1.0) * _Model;
 	vs_out.UV = vUV;
-	vs_out.WorldPosition = vPos;
-	vs_out.WorldNormal = transpose(inverse(mat3(_Model))) * vNormal;
-	gl_Position = _ViewProjection * _Model * vec4(vPos,1.0);
-}
\ No newline at end of file
+	vs_out.WorldPosition = worldPos;
+	vs_out.WorldNormal = _NormalMatrix * vNormal;
+	gl_Position = _ViewProjection * vec4(worldPos,1.0);
+}
@@ -6,11 +6,12 @@ layout(location = 2) in vec2 vUV;
 out vec3 normal;
 out vec3 WorldPosition;
 
-uniform mat4 _Model;
+uniform mat3x4 _Model; //Affine model matrix, columns are the rows of ew::Affine3x4
+uniform mat3 _NormalMatrix; //Inverse transpose of the model matrix, computed on the CPU
 uniform mat4 _ViewProjection;
 
 void main(){
-	WorldPosition = mat3(_Model) * vPos;
-	normal = transpose(inverse(mat3(_Model))) * vNormal;
-	gl_Position = _ViewProjection * _Model * vec4(vPos,1.0);
+	WorldPosition = vec4(vPos,1.0) * _Model;
+	normal = _NormalMatrix * vNormal;
+	gl_Position = _ViewProjection * vec4(WorldPosition,1.0);
 }
@@ -14,6 +14,10 @@
 #include <ew/transform.h>
 #include <ew/camera.h>
 #include <ew/cameraController.h>
+#include <ew/frustum.h>
+#include <ew/meshOptimize.h>
+#include <ew/meshLOD.h>
+#include <ew/meshlets.h>
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 void resetCamera(ew::Camera& camera, ew::CameraController& cameraController);
@@ -78,11 +82,39 @@ int main() {
 	unsigned int brickTexture = ew::loadTexture("assets/brick_color.jpg",GL_REPEAT,GL_LINEAR);
 
 	//Create cube
-	ew::Mesh cubeMesh(ew::createCube(1.0f));
-	ew::Mesh planeMesh(ew::createPlane(5.0f, 5.0f, 10));
-	ew::Mesh sphereMesh(ew::createSphere(0.5f, 64));
-	ew::Mesh cylinderMesh(ew::createCylinder(0.5f, 1.0f, 32));
-	ew::Mesh lightMesh(ew::createSphere(0.1f, 64));
+	ew::MeshData cubeMeshData = ew::createCube(1.0f);
+	ew::MeshData planeMeshData = ew::createPlane(5.0f, 5.0f, 10);
+	ew::MeshData sphereMeshData = ew::createSphere(0.5f, 64);
+	ew::MeshData cylinderMeshData = ew::createCylinder(0.5f, 1.0f, 32);
+
+	//Reorder for the GPU's vertex caches before uploading
+	ew::MeshData* shapeMeshData[] = { &cubeMeshData, &planeMeshData, &sphereMeshData, &cylinderMeshData };
+	ew::VertexCacheReport shapeCacheReports[4];
+	for (int i = 0; i < 4; i++)
+	{
+		shapeCacheReports[i] = ew::optimizeVertexCache(shapeMeshData[i]);
+		ew::optimizeVertexFetch(shapeMeshData[i]);
+	}
+	//The sphere is drawn as meshlets, so the half facing away from the camera can be skipped
+	ew::MeshletData sphereMeshlets = ew::buildMeshlets(sphereMeshData);
+	ew::optimizeVertexFetch(&sphereMeshlets.meshData);
+	std::vector<unsigned int> visibleMeshlets(sphereMeshlets.meshlets.size());
+	size_t numVisibleMeshlets = 0;
+	bool cullMeshlets = true;
+	//Quantized vertices are half the size. Their position transform goes into the model matrix when drawing
+	ew::Mesh cubeMesh(cubeMeshData, ew::VertexFormat::QUANTIZED);
+	ew::Mesh planeMesh(planeMeshData, ew::VertexFormat::QUANTIZED);
+	ew::Mesh sphereMesh(sphereMeshlets.meshData, ew::VertexFormat::QUANTIZED);
+	ew::Mesh cylinderMesh(cylinderMeshData, ew::VertexFormat::QUANTIZED);
+	//Light gizmos are small, so they only need detail up close. Icosphere levels 3 (1280 triangles) down to 0 (20)
+	const float lightRadius = 0.1f;
+	ew::MeshLOD lightLOD;
+	for (int level = 3; level >= 0; level--)
+	{
+		ew::MeshData lightMeshData = ew::createIcosphere(lightRadius, level);
+		lightLOD.addLevel(lightMeshData, ew::getSphereError(lightMeshData, lightRadius));
+	}
+	int lightLevels[4] = { -1, -1, -1, -1 }; //Level each light was drawn with last frame
 
 	//Initialize transforms
 	ew::Transform cubeTransform;
@@ -90,9 +122,16 @@ int main() {
 	ew::Transform sphereTransform;
 	ew::Transform cylinderTransform;
 	ew::Transform lightTransform;
-	planeTransform.position = ew::Vec3(0, -1.0, 0);
-	sphereTransform.position = ew::Vec3(-1.5f, 0.0f, 0.0f);
-	cylinderTransform.position = ew::Vec3(1.5f, 0.0f, 0.0f);
+	planeTransform.setPosition(ew::Vec3(0, -1.0, 0));
+	sphereTransform.setPosition(ew::Vec3(-1.5f, 0.0f, 0.0f));
+	cylinderTransform.setPosition(ew::Vec3(1.5f, 0.0f, 0.0f));
+
+	//Shapes are drawn in a loop so they can be frustum culled
+	const int numShapes = 4;
+	ew::Mesh* shapeMeshes[numShapes] = { &cubeMesh, &planeMesh, &sphereMesh, &cylinderMesh };
+	ew::Transform* shapeTransforms[numShapes] = { &cubeTransform, &planeTransform, &sphereTransform, &cylinderTransform };
+	ew::AABBBatch shapeWorldBounds;
+	std::vector<unsigned int> visibleShapes;
 	
 	Light lights[4];
 	bool enableLight_1 = true;
@@ -152,7 +191,9 @@ int main() {
 		shader.use();
 		glBindTexture(GL_TEXTURE_2D, brickTexture);
 		shader.setInt("_Texture", 0);
-		shader.setMat4("_ViewProjection", camera.ProjectionMatrix() * camera.ViewMatrix());
+		const ew::Mat4 viewProjection = camera.ProjectionMatrix() * camera.ViewMatrix();
+		shader.setMat4("_ViewProjection", viewProjection);
+		const ew::Frustum frustum(viewProjection);
 
 		if (slider)
 		{
@@ -190,32 +231,45 @@ int main() {
 		shader.setFloat("_specularK", mat.specularK);
 		shader.setFloat("_shininess", mat.shininess);
 
-		//Draw shapes
-		shader.setMat4("_Model", cubeTransform.getModelMatrix());
-		cubeMesh.draw();
-
-		shader.setMat4("_Model", planeTransform.getModelMatrix());
-		planeMesh.draw();
-
-		shader.setMat4("_Model", sphereTransform.getModelMatrix());
-		sphereMesh.draw();
-
-		shader.setMat4("_Model", cylinderTransform.getModelMatrix());
-		cylinderMesh.draw();
+		//Draw shapes that are inside the camera frustum
+		shapeWorldBounds.clear();
+		for (int i = 0; i < numShapes; i++)
+		{
+			shapeWorldBounds.add(ew::TransformAABB(shapeMeshes[i]->getBounds().box, shapeTransforms[i]->getModelMatrix()));
+		}
+		frustum.cull(shapeWorldBounds, visibleShapes);
+		numVisibleMeshlets = 0;
+		for (unsigned int i : visibleShapes)
+		{
+			shader.setMat3x4("_Model", shapeTransforms[i]->getAffineMatrix() * shapeMeshes[i]->getPositionTransform());
+			shader.setMat3("_NormalMatrix", shapeTransforms[i]->getNormalMatrix());
+			if (shapeMeshes[i] == &sphereMesh && cullMeshlets) {
+				//Meshlet bounds are in mesh space, so bring the frustum and camera there instead of moving every meshlet
+				const ew::Frustum meshFrustum(viewProjection * shapeTransforms[i]->getModelMatrix());
+				const ew::Vec3 meshCamera = ew::TransformPoint(ew::InverseTRS(shapeTransforms[i]->getAffineMatrix()), camera.position);
+				numVisibleMeshlets = ew::cullMeshlets(sphereMeshlets.meshlets, meshFrustum, meshCamera, visibleMeshlets.data());
+				ew::drawMeshlets(sphereMesh, sphereMeshlets.meshlets, visibleMeshlets.data(), numVisibleMeshlets);
+			}
+			else {
+				shapeMeshes[i]->draw();
+			}
+		}
 
 		//TODO: Render point lights
 
 		light_Shader.use();
-		light_Shader.setMat4("_ViewProjection", camera.ProjectionMatrix() * camera.ViewMatrix());
+		light_Shader.setMat4("_ViewProjection", viewProjection);
 
 		for (int i = 0; i < 4; i++)
 		{
-			if (lights[i].enable)
+			if (lights[i].enable && frustum.intersects(ew::BoundingSphere{ lights[i].position, lightRadius }))
 			{
-				lightTransform.position = lights[i].position;
-				light_Shader.setMat4("_Model", lightTransform.getModelMatrix());
+				lightTransform.setPosition(lights[i].position);
+				light_Shader.setMat3x4("_Model", lightTransform.getAffineMatrix());
+				light_Shader.setMat3("_NormalMatrix", lightTransform.getNormalMatrix());
 				light_Shader.setVec3("_Color", lights[i].color);
-				lightMesh.draw();
+				lightLevels[i] = lightLOD.selectLevel(camera, ew::Magnitude(lights[i].position - camera.position), SCREEN_HEIGHT, lightLevels[i]);
+				lightLOD.draw(lightLevels[i]);
 			}
 		}
 
@@ -309,6 +363,22 @@ int main() {
 					mat.shininess = 10.0;
 				}
 			}
+			ImGui::Text("Shapes drawn: %d / %d", (int)visibleShapes.size(), numShapes);
+			if (ImGui::CollapsingHeader("Vertex Cache")) {
+				const char* shapeNames[numShapes] = { "Cube", "Plane", "Sphere", "Cylinder" };
+				for (int i = 0; i < numShapes; i++)
+				{
+					ImGui::Text("%s ACMR: %.2f -> %.2f", shapeNames[i], shapeCacheReports[i].before.acmr, shapeCacheReports[i].after.acmr);
+				}
+			}
+			if (ImGui::CollapsingHeader("Light LOD")) {
+				ImGui::SliderFloat("Max Pixel Error", &lightLOD.maxPixelError, 0.1f, 10.0f);
+				ImGui::Text("Levels: %d %d %d %d", lightLevels[0], lightLevels[1], lightLevels[2], lightLevels[3]);
+			}
+			if (ImGui::CollapsingHeader("Meshlets")) {
+				ImGui::Checkbox("Cull Sphere Meshlets", &cullMeshlets);
+				ImGui::Text("Sphere meshlets drawn: %d / %d", cullMeshlets ? (int)numVisibleMeshlets : (int)sphereMeshlets.meshlets.size(), (int)sphereMeshlets.meshlets.size());
+			}
 
 			ImGui::ColorEdit3("BG color", &bgColor.x);
 			ImGui::End();
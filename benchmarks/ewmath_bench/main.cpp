@@ -0,0 +1,436 @@
+/*
+	ewMath microbenchmarks.
+	Every benchmark runs its operation over a fixed array of random inputs, so timings include loads/stores the way real code does.
+	Results are the median of several samples, in nanoseconds per operation.
+
+	Usage: ewmath_bench [options]
+		--json <path>        Write results as JSON (this file can be used as a baseline later)
+		--csv <path>         Write results as CSV
+		--baseline <path>    JSON written by a previous run. Exits with 1 if any benchmark got slower than the threshold
+		--threshold <pct>    Allowed slowdown against the baseline, in percent (default 10)
+		--samples <n>        Samples per benchmark (default 15)
+		--min-time <ms>      Minimum duration of one sample (default 5)
+		--filter <text>      Only run benchmarks whose name contains text
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/ewMath/transformations.h>
+#include <ew/ewMath/noise.h>
+#include <ew/transform.h>
+#include <ew/transformBatch.h>
+
+#if defined(EW_SIMD_AVX)
+const char* SIMD_VARIANT = "avx";
+#elif defined(EW_SIMD_SSE)
+const char* SIMD_VARIANT = "sse";
+#elif defined(EW_SIMD_NEON)
+const char* SIMD_VARIANT = "neon";
+#else
+const char* SIMD_VARIANT = "none";
+#endif
+
+#if defined(NDEBUG)
+const bool OPTIMIZED_BUILD = true;
+#else
+const bool OPTIMIZED_BUILD = false;
+#endif
+
+//Number of inputs each benchmark loops over per call. Small enough to stay in L1/L2
+const int OPS_PER_CALL = 1024;
+
+struct Options {
+	const char* jsonPath = nullptr;
+	const char* csvPath = nullptr;
+	const char* baselinePath = nullptr;
+	const char* filter = nullptr;
+	float threshold = 10.0f;
+	int samples = 15;
+	float minSampleMs = 5.0f;
+};
+
+struct Benchmark {
+	const char* name;
+	const char* variant;
+	void(*run)(); //Performs OPS_PER_CALL operations
+};
+
+struct Result {
+	std::string name;
+	std::string variant;
+	double nsPerOp;
+	double minNsPerOp;
+	int samples;
+};
+
+//Inputs and outputs. Global so the compiler can't see through them and fold the benchmarks away
+struct BenchData {
+	std::vector<ew::Mat4> matA, matB, matOut;
+	std::vector<ew::Vec4> vec4In, vec4Out;
+	std::vector<ew::Vec3> vec3A, vec3B, vec3Out;
+	std::vector<float> floatA, floatB, floatOut;
+	std::vector<ew::Transform> eulerTransforms, quatTransforms;
+	ew::TransformBatch eulerBatch, quatBatch, fastTrigBatch;
+};
+BenchData data;
+
+void fillData();
+std::vector<Benchmark> createBenchmarks();
+Result runBenchmark(const Benchmark& benchmark, const Options& options);
+bool writeJson(const char* path, const std::vector<Result>& results);
+bool writeCsv(const char* path, const std::vector<Result>& results);
+bool compareBaseline(const char* path, const std::vector<Result>& results, float threshold);
+bool parseOptions(int argc, char** argv, Options* options);
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, &options)) {
+		return 2;
+	}
+	if (!OPTIMIZED_BUILD) {
+		printf("Warning: NDEBUG is not defined. Timings from a debug build are not meaningful\n");
+	}
+	printf("SIMD: %s\n", SIMD_VARIANT);
+
+	fillData();
+	std::vector<Result> results;
+	for (const Benchmark& benchmark : createBenchmarks())
+	{
+		if (options.filter && !strstr(benchmark.name, options.filter))
+			continue;
+		Result result = runBenchmark(benchmark, options);
+		printf("%-28s %-10s %10.3f ns/op (min %.3f)\n", result.name.c_str(), result.variant.c_str(), result.nsPerOp, result.minNsPerOp);
+		results.push_back(result);
+	}
+
+	if (options.jsonPath && !writeJson(options.jsonPath, results))
+		return 2;
+	if (options.csvPath && !writeCsv(options.csvPath, results))
+		return 2;
+	if (options.baselinePath && !compareBaseline(options.baselinePath, results, options.threshold))
+		return 1;
+	return 0;
+}
+
+//Fixed seed so every run benchmarks the same inputs
+ew::Random inputRandom(12345);
+float randomFloat(float min, float max) {
+	return inputRandom.range(min, max);
+}
+ew::Vec3 randomVec3(float min, float max) {
+	return inputRandom.range(ew::Vec3(min), ew::Vec3(max));
+}
+
+void fillData() {
+	data.matA.resize(OPS_PER_CALL);
+	data.matB.resize(OPS_PER_CALL);
+	data.matOut.resize(OPS_PER_CALL);
+	data.vec4In.resize(OPS_PER_CALL);
+	data.vec4Out.resize(OPS_PER_CALL);
+	data.vec3A.resize(OPS_PER_CALL);
+	data.vec3B.resize(OPS_PER_CALL);
+	data.vec3Out.resize(OPS_PER_CALL);
+	data.floatA.resize(OPS_PER_CALL);
+	data.floatB.resize(OPS_PER_CALL);
+	data.floatOut.resize(OPS_PER_CALL);
+	data.eulerTransforms.resize(OPS_PER_CALL);
+	data.quatTransforms.resize(OPS_PER_CALL);
+	for (int i = 0; i < OPS_PER_CALL; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			data.matA[i][c] = ew::Vec4(randomVec3(-1, 1), randomFloat(-1, 1));
+			data.matB[i][c] = ew::Vec4(randomVec3(-1, 1), randomFloat(-1, 1));
+		}
+		data.vec4In[i] = ew::Vec4(randomVec3(-10, 10), 1.0f);
+		data.vec3A[i] = randomVec3(-10, 10);
+		data.vec3B[i] = randomVec3(-10, 10);
+		data.floatA[i] = randomFloat(0.5f, 2.0f);
+		data.floatB[i] = randomFloat(1.0f, 100.0f);
+
+		ew::Transform& euler = data.eulerTransforms[i];
+		euler.setPosition(randomVec3(-10, 10));
+		euler.setRotation(randomVec3(-180, 180));
+		euler.setScale(randomVec3(0.5f, 2.0f));
+		ew::Transform& quat = data.quatTransforms[i];
+		quat = euler;
+		quat.setOrientation(quat.getOrientation());
+
+		data.eulerBatch.add(euler);
+		data.quatBatch.add(quat);
+	}
+	data.quatBatch.useOrientation = true;
+	data.fastTrigBatch = data.eulerBatch;
+	data.fastTrigBatch.fastTrig = true;
+}
+
+std::vector<Benchmark> createBenchmarks() {
+	std::vector<Benchmark> benchmarks;
+	benchmarks.push_back({ "mat4_mul", "scalar", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.matOut[i] = ew::MulScalar(data.matA[i], data.matB[i]);
+	} });
+#if defined(EW_SIMD)
+	benchmarks.push_back({ "mat4_mul", SIMD_VARIANT, [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.matOut[i] = ew::MulSimd(data.matA[i], data.matB[i]);
+	} });
+#endif
+	benchmarks.push_back({ "mat4_mul_vec4", "scalar", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.vec4Out[i] = ew::MulScalar(data.matA[i], data.vec4In[i]);
+	} });
+#if defined(EW_SIMD)
+	benchmarks.push_back({ "mat4_mul_vec4", SIMD_VARIANT, [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.vec4Out[i] = ew::MulSimd(data.matA[i], data.vec4In[i]);
+	} });
+#endif
+	//Setting the position marks the transform dirty, so every call rebuilds the matrix
+	benchmarks.push_back({ "transform_model_matrix", "euler", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+		{
+			ew::Transform& transform = data.eulerTransforms[i];
+			transform.setPosition(transform.getPosition());
+			data.matOut[i] = transform.getModelMatrix();
+		}
+	} });
+	benchmarks.push_back({ "transform_model_matrix", "quat", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+		{
+			ew::Transform& transform = data.quatTransforms[i];
+			transform.setPosition(transform.getPosition());
+			data.matOut[i] = transform.getModelMatrix();
+		}
+	} });
+	//Same matrices through ew::TransformBatch (SIMD when available), single threaded
+	benchmarks.push_back({ "transform_model_matrix", "batch", [] {
+		data.eulerBatch.computeModelMatrices(data.matOut.data());
+	} });
+	benchmarks.push_back({ "transform_model_matrix", "batch_quat", [] {
+		data.quatBatch.computeModelMatrices(data.matOut.data());
+	} });
+	benchmarks.push_back({ "transform_model_matrix", "batch_fast", [] {
+		data.fastTrigBatch.computeModelMatrices(data.matOut.data());
+	} });
+	benchmarks.push_back({ "look_at", "scalar", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.matOut[i] = ew::LookAt(data.vec3A[i], data.vec3B[i], ew::Vec3(0, 1, 0));
+	} });
+	benchmarks.push_back({ "perspective", "scalar", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.matOut[i] = ew::Perspective(data.floatA[i], 1.7f, 0.1f, data.floatB[i]);
+	} });
+	benchmarks.push_back({ "orthographic", "scalar", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.matOut[i] = ew::Orthographic(data.floatB[i], data.floatA[i], 0.1f, 100.0f);
+	} });
+	benchmarks.push_back({ "normalize", "scalar", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.vec3Out[i] = ew::Normalize(data.vec3A[i]);
+	} });
+	benchmarks.push_back({ "cross", "scalar", [] {
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.vec3Out[i] = ew::Cross(data.vec3A[i], data.vec3B[i]);
+	} });
+	//6 octaves, as terrain uses. One op is one sample at (floatB, floatA)
+	benchmarks.push_back({ "fractal_noise", "scalar", [] {
+		const ew::FractalNoiseSettings settings;
+		for (int i = 0; i < OPS_PER_CALL; i++)
+			data.floatOut[i] = ew::FractalNoise(data.floatB[i], data.floatA[i], settings);
+	} });
+	benchmarks.push_back({ "fractal_noise", "batch", [] {
+		ew::FractalNoise(data.floatB.data(), data.floatA.data(), OPS_PER_CALL, ew::FractalNoiseSettings(), data.floatOut.data());
+	} });
+	return benchmarks;
+}
+
+double elapsedNs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+Result runBenchmark(const Benchmark& benchmark, const Options& options) {
+	//Warm up, then find how many calls make one sample last at least minSampleMs
+	benchmark.run();
+	int calls = 1;
+	while (true)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < calls; i++)
+			benchmark.run();
+		if (elapsedNs(start) >= options.minSampleMs * 1e6 || calls >= (1 << 24))
+			break;
+		calls *= 2;
+	}
+
+	std::vector<double> samples(options.samples);
+	for (int s = 0; s < options.samples; s++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < calls; i++)
+			benchmark.run();
+		samples[s] = elapsedNs(start) / ((double)calls * OPS_PER_CALL);
+	}
+	std::sort(samples.begin(), samples.end());
+
+	Result result;
+	result.name = benchmark.name;
+	result.variant = benchmark.variant;
+	result.nsPerOp = samples[samples.size() / 2];
+	result.minNsPerOp = samples[0];
+	result.samples = options.samples;
+	return result;
+}
+
+bool writeJson(const char* path, const std::vector<Result>& results) {
+	FILE* file = fopen(path, "w");
+	if (!file) {
+		printf("Failed to open %s for writing\n", path);
+		return false;
+	}
+	fprintf(file, "{\n\t\"simd\": \"%s\",\n\t\"optimized\": %s,\n\t\"ops_per_call\": %d,\n\t\"results\": [\n", SIMD_VARIANT, OPTIMIZED_BUILD ? "true" : "false", OPS_PER_CALL);
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& r = results[i];
+		fprintf(file, "\t\t{ \"name\": \"%s\", \"variant\": \"%s\", \"ns_per_op\": %.4f, \"min_ns_per_op\": %.4f, \"samples\": %d }%s\n",
+			r.name.c_str(), r.variant.c_str(), r.nsPerOp, r.minNsPerOp, r.samples, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "\t]\n}\n");
+	fclose(file);
+	return true;
+}
+
+bool writeCsv(const char* path, const std::vector<Result>& results) {
+	FILE* file = fopen(path, "w");
+	if (!file) {
+		printf("Failed to open %s for writing\n", path);
+		return false;
+	}
+	fprintf(file, "name,variant,ns_per_op,min_ns_per_op,samples\n");
+	for (const Result& r : results)
+	{
+		fprintf(file, "%s,%s,%.4f,%.4f,%d\n", r.name.c_str(), r.variant.c_str(), r.nsPerOp, r.minNsPerOp, r.samples);
+	}
+	fclose(file);
+	return true;
+}
+
+//Finds "key": after pos and returns the position just past the colon, or npos
+size_t findKey(const std::string& text, const char* key, size_t pos) {
+	std::string quoted = std::string("\"") + key + "\"";
+	pos = text.find(quoted, pos);
+	if (pos == std::string::npos)
+		return pos;
+	pos = text.find(':', pos + quoted.size());
+	return pos == std::string::npos ? pos : pos + 1;
+}
+std::string readString(const std::string& text, size_t pos) {
+	size_t start = text.find('"', pos);
+	size_t end = start == std::string::npos ? start : text.find('"', start + 1);
+	if (end == std::string::npos)
+		return "";
+	return text.substr(start + 1, end - start - 1);
+}
+
+//Reads the results array of a file written by writeJson. Not a general JSON parser
+bool readBaseline(const char* path, std::vector<Result>* baseline) {
+	FILE* file = fopen(path, "rb");
+	if (!file) {
+		printf("Failed to open baseline %s\n", path);
+		return false;
+	}
+	std::string text;
+	char buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		text.append(buffer, read);
+	fclose(file);
+
+	size_t pos = 0;
+	while ((pos = findKey(text, "name", pos)) != std::string::npos)
+	{
+		Result r;
+		r.name = readString(text, pos);
+		size_t variantPos = findKey(text, "variant", pos);
+		size_t nsPos = findKey(text, "ns_per_op", pos);
+		if (variantPos == std::string::npos || nsPos == std::string::npos)
+			break;
+		r.variant = readString(text, variantPos);
+		r.nsPerOp = strtod(text.c_str() + nsPos, nullptr);
+		r.minNsPerOp = r.nsPerOp;
+		r.samples = 0;
+		baseline->push_back(r);
+		pos = nsPos;
+	}
+	return true;
+}
+
+bool compareBaseline(const char* path, const std::vector<Result>& results, float threshold) {
+	std::vector<Result> baseline;
+	if (!readBaseline(path, &baseline))
+		return false;
+
+	printf("\nAgainst baseline %s (threshold +%.1f%%)\n", path, threshold);
+	int regressions = 0;
+	for (const Result& r : results)
+	{
+		auto it = std::find_if(baseline.begin(), baseline.end(), [&](const Result& b) {
+			return b.name == r.name && b.variant == r.variant;
+		});
+		if (it == baseline.end() || it->nsPerOp <= 0) {
+			printf("%-28s %-10s not in baseline\n", r.name.c_str(), r.variant.c_str());
+			continue;
+		}
+		double change = (r.nsPerOp - it->nsPerOp) / it->nsPerOp * 100.0;
+		bool regressed = change > threshold;
+		regressions += regressed;
+		printf("%-28s %-10s %10.3f -> %10.3f ns/op %+7.1f%%%s\n", r.name.c_str(), r.variant.c_str(), it->nsPerOp, r.nsPerOp, change, regressed ? "  REGRESSION" : "");
+	}
+	if (regressions > 0) {
+		printf("%d benchmark(s) regressed by more than %.1f%%\n", regressions, threshold);
+		return false;
+	}
+	return true;
+}
+
+bool parseOptions(int argc, char** argv, Options* options) {
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (!strcmp(arg, "--help") || !strcmp(arg, "-h")) {
+			printf("Usage: %s [--json path] [--csv path] [--baseline path] [--threshold pct] [--samples n] [--min-time ms] [--filter text]\n", argv[0]);
+			return false;
+		}
+		if (i + 1 >= argc) {
+			printf("Missing value for %s\n", arg);
+			return false;
+		}
+		const char* value = argv[++i];
+		if (!strcmp(arg, "--json"))
+			options->jsonPath = value;
+		else if (!strcmp(arg, "--csv"))
+			options->csvPath = value;
+		else if (!strcmp(arg, "--baseline"))
+			options->baselinePath = value;
+		else if (!strcmp(arg, "--filter"))
+			options->filter = value;
+		else if (!strcmp(arg, "--threshold"))
+			options->threshold = (float)atof(value);
+		else if (!strcmp(arg, "--samples"))
+			options->samples = std::max(1, atoi(value));
+		else if (!strcmp(arg, "--min-time"))
+			options->minSampleMs = (float)atof(value);
+		else {
+			printf("Unknown option %s\n", arg);
+			return false;
+		}
+	}
+	return true;
+}
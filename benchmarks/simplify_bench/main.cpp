@@ -0,0 +1,140 @@
+/*
+	Measures ew::simplify on meshes of about 1 million triangles.
+	Each input is reduced to several fractions of its triangles. For each run it reports the triangles kept, the error
+	simplify reports, the largest distance from the true sphere (sphere inputs only, as a fraction of the radius) and the
+	median time. Then all inputs are simplified one after another and with simplifyBatch, to show the speedup of
+	simplifying independent meshes on the job threads.
+
+	Usage: simplify_bench [options]
+		--csv <path>         Write results as CSV
+		--samples <n>        Runs per setting, for the timing median (default 3)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/procGen.h>
+#include <ew/simplify.h>
+#include <ew/jobs.h>
+
+#if defined(NDEBUG)
+const bool OPTIMIZED_BUILD = true;
+#else
+const bool OPTIMIZED_BUILD = false;
+#endif
+
+const float RADIUS = 1.0f;
+
+struct Input {
+	const char* name;
+	ew::MeshData meshData;
+	bool isSphere;
+};
+
+struct Result {
+	const char* input;
+	float ratio;
+	size_t numTriangles;
+	size_t numSimplified;
+	double error;
+	double sphereError;
+	double ms;
+};
+
+template<typename Run>
+double medianMs(int samples, const Run& run) {
+	std::vector<double> times;
+	for (int i = 0; i < samples; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		run();
+		times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+int main(int argc, char** argv) {
+	const char* csvPath = nullptr;
+	int samples = 3;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--csv") && i + 1 < argc)
+			csvPath = argv[++i];
+		else if (!strcmp(argv[i], "--samples") && i + 1 < argc)
+			samples = std::max(atoi(argv[++i]), 1);
+		else {
+			printf("Unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	if (!OPTIMIZED_BUILD) {
+		printf("Warning: NDEBUG is not defined. Timings from a debug build are not meaningful\n");
+	}
+
+	//About 1M triangles each
+	std::vector<Input> inputs;
+	inputs.push_back({ "createSphere", ew::createSphere(RADIUS, 708), true });
+	inputs.push_back({ "createCubeSphere", ew::createCubeSphere(RADIUS, 289), true });
+	inputs.push_back({ "createPlane", ew::createPlane(2.0f, 2.0f, 708), false });
+
+	std::vector<Result> results;
+	for (const Input& input : inputs)
+	{
+		for (float ratio : { 0.5f, 0.1f, 0.01f })
+		{
+			size_t targetIndexCount = (size_t)(input.meshData.getNumIndices() * ratio);
+			ew::MeshData simplified;
+			float error = 0.0f;
+			double ms = medianMs(samples, [&]() { simplified = ew::simplify(input.meshData, targetIndexCount, FLT_MAX, &error); });
+			double sphereError = input.isSphere ? ew::getSphereError(simplified, RADIUS) / RADIUS : 0.0;
+			results.push_back({ input.name, ratio, input.meshData.getNumIndices() / 3, simplified.getNumIndices() / 3, error, sphereError, ms });
+		}
+	}
+
+	printf("%-18s %6s %10s %10s %12s %12s %10s\n", "input", "ratio", "triangles", "simplified", "error", "sphere error", "ms");
+	for (const Result& r : results)
+	{
+		printf("%-18s %6.2f %10zu %10zu %12.3e %12.3e %10.1f\n", r.input, r.ratio, r.numTriangles, r.numSimplified, r.error, r.sphereError, r.ms);
+	}
+
+	//Every input to 10%, one at a time and then as one batch
+	std::vector<ew::MeshData> outputs(inputs.size());
+	std::vector<ew::SimplifyJob> jobs(inputs.size());
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		jobs[i] = { &inputs[i].meshData, inputs[i].meshData.getNumIndices() / 10, FLT_MAX, &outputs[i], 0.0f };
+	}
+	double sequentialMs = medianMs(samples, [&]() {
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			outputs[i] = ew::simplify(inputs[i].meshData, jobs[i].targetIndexCount, FLT_MAX);
+		}
+	});
+	double batchMs = medianMs(samples, [&]() { ew::simplifyBatch(jobs.data(), jobs.size()); });
+	printf("\n%zu meshes to 10%%: sequential %.1f ms, simplifyBatch %.1f ms (%.2fx, %d job threads)\n",
+		inputs.size(), sequentialMs, batchMs, sequentialMs / batchMs, ew::getNumJobThreads());
+
+	if (csvPath) {
+		FILE* file = fopen(csvPath, "w");
+		if (!file) {
+			printf("Could not write %s\n", csvPath);
+			return 2;
+		}
+		fprintf(file, "input,ratio,triangles,simplified,error,sphere_error,ms\n");
+		for (const Result& r : results)
+		{
+			fprintf(file, "%s,%.2f,%zu,%zu,%.6e,%.6e,%.3f\n", r.input, r.ratio, r.numTriangles, r.numSimplified, r.error, r.sphereError, r.ms);
+		}
+		fprintf(file, "batch_sequential,0.10,,,,,%.3f\n", sequentialMs);
+		fprintf(file, "batch_simplifyBatch,0.10,,,,,%.3f\n", batchMs);
+		fclose(file);
+	}
+	return 0;
+}
@@ -0,0 +1,105 @@
+/*
+	Compares the sphere generators by how many triangles they need for a given roundness.
+	For each generator and quality setting it reports the triangle count, the largest distance between the mesh surface and the
+	true sphere (as a fraction of the radius) and the median build time.
+	Every vertex lies on the sphere, so the error is how far the flattest part of a triangle sags toward the center.
+
+	Usage: sphere_bench [options]
+		--csv <path>         Write results as CSV
+		--samples <n>        Builds per setting, for the timing median (default 5)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/procGen.h>
+
+#if defined(NDEBUG)
+const bool OPTIMIZED_BUILD = true;
+#else
+const bool OPTIMIZED_BUILD = false;
+#endif
+
+const float RADIUS = 1.0f;
+
+struct Result {
+	const char* generator;
+	int setting;
+	size_t numVertices;
+	size_t numTriangles;
+	double maxError;
+	double buildMs;
+};
+
+template<typename Build>
+Result measure(const char* generator, int setting, int samples, const Build& build) {
+	ew::MeshData meshData;
+	std::vector<double> times;
+	for (int i = 0; i < samples; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		meshData = build();
+		times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	std::sort(times.begin(), times.end());
+	return { generator, setting, meshData.vertices.size(), meshData.getNumIndices() / 3, ew::getSphereError(meshData, RADIUS) / RADIUS, times[times.size() / 2] };
+}
+
+int main(int argc, char** argv) {
+	const char* csvPath = nullptr;
+	int samples = 5;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--csv") && i + 1 < argc)
+			csvPath = argv[++i];
+		else if (!strcmp(argv[i], "--samples") && i + 1 < argc)
+			samples = std::max(atoi(argv[++i]), 1);
+		else {
+			printf("Unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	if (!OPTIMIZED_BUILD) {
+		printf("Warning: NDEBUG is not defined. Timings from a debug build are not meaningful\n");
+	}
+
+	std::vector<Result> results;
+	for (int subdivisions : { 8, 16, 32, 64, 128, 256 })
+	{
+		results.push_back(measure("createSphere", subdivisions, samples, [&]() { return ew::createSphere(RADIUS, subdivisions); }));
+	}
+	for (int level = 0; level <= 6; level++)
+	{
+		results.push_back(measure("createIcosphere", level, samples, [&]() { return ew::createIcosphere(RADIUS, level); }));
+	}
+	for (int subdivisions : { 2, 4, 8, 16, 32, 64, 128 })
+	{
+		results.push_back(measure("createCubeSphere", subdivisions, samples, [&]() { return ew::createCubeSphere(RADIUS, subdivisions); }));
+	}
+
+	printf("%-18s %8s %10s %10s %12s %10s\n", "generator", "setting", "vertices", "triangles", "max error", "build ms");
+	for (const Result& r : results)
+	{
+		printf("%-18s %8d %10zu %10zu %12.3e %10.3f\n", r.generator, r.setting, r.numVertices, r.numTriangles, r.maxError, r.buildMs);
+	}
+
+	if (csvPath) {
+		FILE* file = fopen(csvPath, "w");
+		if (!file) {
+			printf("Could not write %s\n", csvPath);
+			return 2;
+		}
+		fprintf(file, "generator,setting,vertices,triangles,max_error,build_ms\n");
+		for (const Result& r : results)
+		{
+			fprintf(file, "%s,%d,%zu,%zu,%.6e,%.6f\n", r.generator, r.setting, r.numVertices, r.numTriangles, r.maxError, r.buildMs);
+		}
+		fclose(file);
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+/*
+	Measures how long ew::Terrain takes to build its chunks, without uploading them (no OpenGL needed).
+	For each LOD of the default settings it reports the vertices and triangles of one chunk and the median time to build it.
+	Then one update's worth of LOD 0 chunks (maxBuildsPerUpdate) is built one after another and as one batch on the job threads,
+	which is what Terrain::update does each frame while streaming.
+
+	Usage: terrain_bench [options]
+		--csv <path>         Write results as CSV
+		--samples <n>        Runs per setting, for the timing median (default 5)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+
+#include <ew/terrain.h>
+#include <ew/jobs.h>
+
+#if defined(NDEBUG)
+const bool OPTIMIZED_BUILD = true;
+#else
+const bool OPTIMIZED_BUILD = false;
+#endif
+
+struct Result {
+	int lod;
+	size_t numVertices;
+	size_t numTriangles;
+	double ms;
+};
+
+template<typename Run>
+double medianMs(int samples, const Run& run) {
+	std::vector<double> times;
+	for (int i = 0; i < samples; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		run();
+		times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+int main(int argc, char** argv) {
+	const char* csvPath = nullptr;
+	int samples = 5;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--csv") && i + 1 < argc)
+			csvPath = argv[++i];
+		else if (!strcmp(argv[i], "--samples") && i + 1 < argc)
+			samples = std::max(atoi(argv[++i]), 1);
+		else {
+			printf("Unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	if (!OPTIMIZED_BUILD) {
+		printf("Warning: NDEBUG is not defined. Timings from a debug build are not meaningful\n");
+	}
+#if defined(EW_SIMD)
+	printf("SIMD noise: yes\n");
+#else
+	printf("SIMD noise: no\n");
+#endif
+
+	const ew::Terrain terrain;
+	const ew::TerrainSettings& settings = terrain.getSettings();
+	std::vector<Result> results;
+	ew::MeshData meshData;
+	for (int lod = 0; lod < settings.numLods; lod++)
+	{
+		const int edgeLods[4] = { lod, lod, lod, lod };
+		double ms = medianMs(samples, [&]() { terrain.buildChunk(0, 0, lod, edgeLods, &meshData); });
+		results.push_back({ lod, meshData.vertices.size(), meshData.getNumIndices() / 3, ms });
+	}
+
+	printf("%4s %10s %10s %10s\n", "lod", "vertices", "triangles", "ms");
+	for (const Result& r : results)
+	{
+		printf("%4d %10zu %10zu %10.3f\n", r.lod, r.numVertices, r.numTriangles, r.ms);
+	}
+
+	//One update's batch of LOD 0 chunks, in a row along x
+	const size_t batchSize = settings.maxBuildsPerUpdate;
+	std::vector<ew::MeshData> batch(batchSize);
+	const int edgeLods[4] = { 0, 0, 0, 0 };
+	auto build = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+		{
+			terrain.buildChunk((int)i, 0, 0, edgeLods, &batch[i]);
+		}
+	};
+	double sequentialMs = medianMs(samples, [&]() { build(0, batchSize); });
+	double batchMs = medianMs(samples, [&]() { ew::parallelFor(batchSize, 1, std::cref(build)); });
+	printf("\n%zu LOD 0 chunks: sequential %.1f ms, job threads %.1f ms (%.2fx, %d job threads)\n",
+		batchSize, sequentialMs, batchMs, sequentialMs / batchMs, ew::getNumJobThreads());
+
+	if (csvPath) {
+		FILE* file = fopen(csvPath, "w");
+		if (!file) {
+			printf("Could not write %s\n", csvPath);
+			return 2;
+		}
+		fprintf(file, "lod,vertices,triangles,ms\n");
+		for (const Result& r : results)
+		{
+			fprintf(file, "%d,%zu,%zu,%.3f\n", r.lod, r.numVertices, r.numTriangles, r.ms);
+		}
+		fprintf(file, "batch_sequential,,,%.3f\n", sequentialMs);
+		fprintf(file, "batch_jobs,,,%.3f\n", batchMs);
+		fclose(file);
+	}
+	return 0;
+}
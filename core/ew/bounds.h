@@ -0,0 +1,24 @@
+#pragma once
+#include "ewMath/ewMath.h"
+
+namespace ew {
+	struct BoundingSphere {
+		ew::Vec3 center;
+		float radius;
+	};
+	struct AABB {
+		ew::Vec3 min;
+		ew::Vec3 max;
+	};
+
+	//Box and sphere around a mesh in its own space. Culling can test whichever is cheaper or tighter for the shape
+	struct MeshBounds {
+		AABB box;
+		BoundingSphere sphere;
+	};
+
+	//Bounds of a shape centered on the origin, given the half size of its box and the radius of its bounding sphere
+	constexpr MeshBounds CenteredBounds(const ew::Vec3& halfExtents, float radius) {
+		return MeshBounds{ AABB{ ew::Vec3(-halfExtents.x, -halfExtents.y, -halfExtents.z), halfExtents }, BoundingSphere{ ew::Vec3(0.0f), radius } };
+	}
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include "mat4.h"
+#include "vec3.h"
+#include "mat3.h"
+#include "simd.h"
+
+namespace ew {
+	//Affine transform stored as the top 3 rows of a 4x4 matrix. The bottom row is always (0,0,0,1) and is not stored.
+	//The 12 floats are 3 contiguous rows, which is exactly what a GLSL mat3x4 holds when used as vec4(p, 1) * m.
+	//48 bytes instead of 64 per transform when uploaded.
+	struct Affine3x4 {
+	private:
+		Vec4 r[3];
+	public:
+		Affine3x4() = default;
+		constexpr Affine3x4(const Vec4& row0, const Vec4& row1, const Vec4& row2)
+			:r{ row0, row1, row2 }
+		{}
+		//Drops the bottom row, which must be (0,0,0,1) for the result to be meaningful
+		constexpr explicit Affine3x4(const Mat4& m)
+			:r{ Vec4(m[0].x, m[1].x, m[2].x, m[3].x), Vec4(m[0].y, m[1].y, m[2].y, m[3].y), Vec4(m[0].z, m[1].z, m[2].z, m[3].z) }
+		{}
+		//Access a row
+		constexpr Vec4& operator[](int i) {
+			return r[i];
+		}
+		constexpr const Vec4& operator[](int i) const {
+			return r[i];
+		}
+		constexpr Mat4 toMat4() const {
+			return Mat4(
+				r[0].x, r[0].y, r[0].z, r[0].w,
+				r[1].x, r[1].y, r[1].z, r[1].w,
+				r[2].x, r[2].y, r[2].z, r[2].w,
+				0.0f, 0.0f, 0.0f, 1.0f
+			);
+		}
+	};
+
+	constexpr Affine3x4 AffineIdentity() {
+		return Affine3x4(
+			Vec4(1.0f, 0.0f, 0.0f, 0.0f),
+			Vec4(0.0f, 1.0f, 0.0f, 0.0f),
+			Vec4(0.0f, 0.0f, 1.0f, 0.0f)
+		);
+	}
+
+	//Affine * affine. Skips the implicit bottom row, so 36 multiplies instead of 64
+	constexpr Affine3x4 MulScalar(const Affine3x4& a, const Affine3x4& b) {
+		Affine3x4 m;
+		for (int i = 0; i < 3; i++)
+		{
+			const Vec4& ar = a[i];
+			m[i] = Vec4(
+				ar.x * b[0].x + ar.y * b[1].x + ar.z * b[2].x,
+				ar.x * b[0].y + ar.y * b[1].y + ar.z * b[2].y,
+				ar.x * b[0].z + ar.y * b[1].z + ar.z * b[2].z,
+				ar.x * b[0].w + ar.y * b[1].w + ar.z * b[2].w + ar.w
+			);
+		}
+		return m;
+	}
+#if defined(EW_SIMD)
+	inline Affine3x4 MulSimd(const Affine3x4& a, const Affine3x4& b) {
+		const simd::float4 b0 = simd::Load(&b[0].x);
+		const simd::float4 b1 = simd::Load(&b[1].x);
+		const simd::float4 b2 = simd::Load(&b[2].x);
+		//Bottom row of b, picks up the translation of a
+		const Vec4 bottomRow = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		const simd::float4 b3 = simd::Load(&bottomRow.x);
+		Affine3x4 m;
+		for (int i = 0; i < 3; i++)
+		{
+			simd::float4 ar = simd::Load(&a[i].x);
+			simd::float4 c = simd::Mul(simd::SplatLane<0>(ar), b0);
+			c = simd::Add(c, simd::Mul(simd::SplatLane<1>(ar), b1));
+			c = simd::Add(c, simd::Mul(simd::SplatLane<2>(ar), b2));
+			c = simd::Add(c, simd::Mul(simd::SplatLane<3>(ar), b3));
+			simd::Store(&m[i].x, c);
+		}
+		return m;
+	}
+#endif
+	EW_SIMD_CONSTEXPR Affine3x4 operator * (const Affine3x4& a, const Affine3x4& b) {
+#if defined(EW_SIMD)
+#if defined(EW_IS_CONSTANT_EVALUATED)
+		if (EW_IS_CONSTANT_EVALUATED())
+			return MulScalar(a, b);
+#endif
+		return MulSimd(a, b);
+#else
+		return MulScalar(a, b);
+#endif
+	}
+
+	//Transforms a position (w = 1)
+	constexpr Vec3 TransformPoint(const Affine3x4& m, const Vec3& p) {
+		return Vec3(
+			m[0].x * p.x + m[0].y * p.y + m[0].z * p.z + m[0].w,
+			m[1].x * p.x + m[1].y * p.y + m[1].z * p.z + m[1].w,
+			m[2].x * p.x + m[2].y * p.y + m[2].z * p.z + m[2].w
+		);
+	}
+	//Transforms a direction (w = 0). Ignores translation
+	constexpr Vec3 TransformVector(const Affine3x4& m, const Vec3& v) {
+		return Vec3(
+			m[0].x * v.x + m[0].y * v.y + m[0].z * v.z,
+			m[1].x * v.x + m[1].y * v.y + m[1].z * v.z,
+			m[2].x * v.x + m[2].y * v.y + m[2].z * v.z
+		);
+	}
+
+	//Inverse of any invertible affine transform: inverse of the 3x3 part, then translation = -inverse * t
+	//Returns identity if the 3x3 part is singular
+	constexpr Affine3x4 Inverse(const Affine3x4& m) {
+		const Vec3 a = m[0].toVec3();
+		const Vec3 b = m[1].toVec3();
+		const Vec3 c = m[2].toVec3();
+		//Columns of the inverse are the cross products of the rows, divided by the determinant
+		const Vec3 bc = Cross(b, c);
+		const Vec3 ca = Cross(c, a);
+		const Vec3 ab = Cross(a, b);
+		const float det = Dot(a, bc);
+		if (det == 0)
+			return AffineIdentity();
+		const float invDet = 1.0f / det;
+		const Vec3 t = Vec3(m[0].w, m[1].w, m[2].w);
+		Affine3x4 inv(
+			Vec4(bc.x * invDet, ca.x * invDet, ab.x * invDet, 0.0f),
+			Vec4(bc.y * invDet, ca.y * invDet, ab.y * invDet, 0.0f),
+			Vec4(bc.z * invDet, ca.z * invDet, ab.z * invDet, 0.0f)
+		);
+		const Vec3 invT = -TransformVector(inv, t);
+		inv[0].w = invT.x;
+		inv[1].w = invT.y;
+		inv[2].w = invT.z;
+		return inv;
+	}
+
+	//Inverse of a translate * rotate * scale transform (no shear), e.g. a model matrix from ew::TRS or ew::Transform.
+	//The 3x3 part has orthogonal columns, so each row of its inverse is a column divided by its squared length. No determinant, no cross products.
+	//Gives wrong results for sheared matrices (parents with non-uniform scale and rotation) - use Inverse for those
+	constexpr Affine3x4 InverseTRS(const Affine3x4& m) {
+		const Vec3 c0 = Vec3(m[0].x, m[1].x, m[2].x);
+		const Vec3 c1 = Vec3(m[0].y, m[1].y, m[2].y);
+		const Vec3 c2 = Vec3(m[0].z, m[1].z, m[2].z);
+		const Vec3 r0 = c0 * (1.0f / Dot(c0, c0));
+		const Vec3 r1 = c1 * (1.0f / Dot(c1, c1));
+		const Vec3 r2 = c2 * (1.0f / Dot(c2, c2));
+		const Vec3 t = Vec3(m[0].w, m[1].w, m[2].w);
+		return Affine3x4(
+			Vec4(r0.x, r0.y, r0.z, -Dot(r0, t)),
+			Vec4(r1.x, r1.y, r1.z, -Dot(r1, t)),
+			Vec4(r2.x, r2.y, r2.z, -Dot(r2, t))
+		);
+	}
+
+	//Inverse transpose of the 3x3 part, for transforming normals into world space.
+	//The inverse transpose is the cofactor matrix divided by the determinant, and the cofactor rows are the cross products of the rows of m.
+	//Returns identity if the 3x3 part is singular
+	constexpr Mat3 NormalMatrix(const Affine3x4& m) {
+		const Vec3 a = m[0].toVec3();
+		const Vec3 b = m[1].toVec3();
+		const Vec3 c = m[2].toVec3();
+		const Vec3 bc = Cross(b, c);
+		const Vec3 ca = Cross(c, a);
+		const Vec3 ab = Cross(a, b);
+		const float det = Dot(a, bc);
+		if (det == 0)
+			return Mat3(Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f));
+		const float invDet = 1.0f / det;
+		return Mat3(
+			bc.x * invDet, bc.y * invDet, bc.z * invDet,
+			ca.x * invDet, ca.y * invDet, ca.z * invDet,
+			ab.x * invDet, ab.y * invDet, ab.z * invDet
+		);
+	}
+	constexpr Mat3 NormalMatrix(const Mat4& m) {
+		return NormalMatrix(Affine3x4(m));
+	}
+}
@@ -0,0 +1,56 @@
+/*
+	Compile time checks for ewMath. Nothing here runs: if any of these stop being constant expressions
+	(or give the wrong answer) the core library fails to build.
+*/
+
+#include "ewMath.h"
+#include "transformations.h"
+
+namespace ew {
+	namespace {
+		constexpr bool Equals(const Vec4& a, const Vec4& b) {
+			return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+		}
+		constexpr bool Equals(const Mat4& a, const Mat4& b) {
+			return Equals(a[0], b[0]) && Equals(a[1], b[1]) && Equals(a[2], b[2]) && Equals(a[3], b[3]);
+		}
+		constexpr bool Equals(const Vec3& a, const Vec3& b) {
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		}
+
+		//Vectors
+		static_assert(Equals(Vec3(1, 2, 3) + Vec3(4, 5, 6), Vec3(5, 7, 9)), "Vec3 addition");
+		static_assert(Equals(Vec3(1, 2, 3) * 2.0f - Vec3(1), Vec3(1, 3, 5)), "Vec3 scale/subtract");
+		static_assert(Equals(-Vec3(1, -2, 3), Vec3(-1, 2, -3)), "Vec3 negate");
+		static_assert(Dot(Vec3(1, 2, 3), Vec3(4, 5, 6)) == 32.0f, "Vec3 dot");
+		static_assert(Equals(Cross(Vec3(1, 0, 0), Vec3(0, 1, 0)), Vec3(0, 0, 1)), "Vec3 cross");
+		static_assert(Equals(Vec4(Vec3(1, 2, 3), 1.0f) * 2.0f, Vec4(2, 4, 6, 1)), "Vec4 scale leaves w alone");
+		static_assert(Radians(180.0f) == PI, "Radians");
+
+		//Identity, scale, translate
+		constexpr Mat4 identity = Identity();
+		static_assert(Equals(identity, IdentityMatrix()), "Identity");
+		static_assert(Equals(identity[0], Vec4(1, 0, 0, 0)) && Equals(identity[3], Vec4(0, 0, 0, 1)), "Identity columns");
+		constexpr Mat4 scale = Scale(Vec3(2, 3, 4));
+		static_assert(scale[0].x == 2 && scale[1].y == 3 && scale[2].z == 4 && scale[3].w == 1, "Scale");
+		constexpr Mat4 translate = Translate(Vec3(5, 6, 7));
+		static_assert(Equals(translate[3], Vec4(5, 6, 7, 1)), "Translate puts t in the last column");
+
+		//Multiply
+		static_assert(Equals(translate * Vec4(1, 1, 1, 1), Vec4(6, 7, 8, 1)), "Translate a point");
+		static_assert(Equals(translate * Vec4(1, 1, 1, 0), Vec4(1, 1, 1, 0)), "Translate ignores directions");
+		static_assert(Equals(identity * scale, scale) && Equals(scale * identity, scale), "Identity is neutral");
+		constexpr Mat4 ts = translate * scale;
+		static_assert(Equals(ts * Vec4(1, 1, 1, 1), Vec4(7, 9, 11, 1)), "Scale first, then translate");
+		static_assert(Equals(ts, TRSSinCos(Vec3(5, 6, 7), Vec3(0), Vec3(1), Vec3(2, 3, 4))), "TRS with no rotation");
+		static_assert(Equals(Transpose(Transpose(ts)), ts), "Transpose");
+		static_assert(Equals(Inverse(translate), Translate(Vec3(-5, -6, -7))), "Inverse of a translation");
+
+		//Affine and quaternion paths
+		static_assert(Equals(AffineIdentity().toMat4(), identity), "Affine identity");
+		static_assert(Equals((Affine3x4(translate) * Affine3x4(scale)).toMat4(), ts), "Affine multiply");
+		static_assert(Equals(TransformPoint(InverseTRS(Affine3x4(ts)), Vec3(7, 9, 11)), Vec3(1, 1, 1)), "InverseTRS");
+		static_assert(Equals(TRS(Vec3(5, 6, 7), Quat(), Vec3(2, 3, 4)), ts), "Quaternion TRS with identity rotation");
+		static_assert(Equals(Rotate(Quat(0, 0, 1, 0), Vec3(1, 0, 0)), Vec3(-1, 0, 0)), "180 degree quaternion rotation");
+	}
+}
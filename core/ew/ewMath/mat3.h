@@ -0,0 +1,39 @@
+#pragma once
+#include "vec3.h"
+
+namespace ew {
+	//3x3 column major matrix, mainly used for normal matrices. Same 9 float layout glUniformMatrix3fv expects
+	struct Mat3 {
+	private:
+		Vec3 n[3]; //Columns
+	public:
+		Mat3() = default;
+		constexpr Mat3(float n00, float n10, float n20,
+			 float n01, float n11, float n21,
+			 float n02, float n12, float n22)
+			:n{ Vec3(n00, n01, n02), Vec3(n10, n11, n12), Vec3(n20, n21, n22) }
+		{};
+		//From 3 columns
+		constexpr Mat3(const Vec3& a, const Vec3& b, const Vec3& c)
+			:n{ a, b, c }
+		{}
+		//Access a column
+		constexpr Vec3& operator[](int i) {
+			return n[i];
+		}
+		constexpr const Vec3& operator[](int i) const {
+			return n[i];
+		}
+	};
+	constexpr Vec3 operator * (const Mat3& m, const Vec3& v) {
+		return m[0] * v.x + m[1] * v.y + m[2] * v.z;
+	}
+	constexpr Mat3 Transpose(const Mat3& m) {
+		//Columns of m become rows
+		return Mat3(
+			m[0].x, m[0].y, m[0].z,
+			m[1].x, m[1].y, m[1].z,
+			m[2].x, m[2].y, m[2].z
+		);
+	}
+}
@@ -4,77 +4,123 @@
 
 #pragma once
 #include "vec4.h"
+#include "simd.h"
 #include <cstddef>
 
 namespace ew {
 	struct Mat4 {
 	private:
-		float n[4][4];
+		Vec4 n[4]; //Columns. Same 16 contiguous floats as float[4][4], but usable in constant expressions
 	public:
 		Mat4() = default;
-		Mat4(float n00)
-		{
-			n[0][0] = n00; n[1][0] = n00; n[2][0] = n00; n[3][0] = n00;
-			n[0][1] = n00; n[1][1] = n00; n[2][1] = n00; n[3][1] = n00;
-			n[0][2] = n00; n[1][2] = n00; n[2][2] = n00; n[3][2] = n00;
-			n[0][3] = n00; n[1][3] = n00; n[2][3] = n00; n[3][3] = n00;
-		};
-		Mat4(float n00, float n10, float n20, float n30,
+		constexpr Mat4(float n00)
+			:n{ Vec4(n00), Vec4(n00), Vec4(n00), Vec4(n00) }
+		{};
+		constexpr Mat4(float n00, float n10, float n20, float n30,
 			 float n01, float n11, float n21, float n31,
 			 float n02, float n12, float n22, float n32,
 			 float n03, float n13, float n23, float n33)
-		{
-			n[0][0] = n00; n[1][0] = n10; n[2][0] = n20; n[3][0] = n30;
-			n[0][1] = n01; n[1][1] = n11; n[2][1] = n21; n[3][1] = n31;
-			n[0][2] = n02; n[1][2] = n12; n[2][2] = n22; n[3][2] = n32;
-			n[0][3] = n03; n[1][3] = n13; n[2][3] = n23; n[3][3] = n33;
-		};
-		Mat4(const Vec4& a, const Vec4& b, const Vec4& c, const Vec4& d) {
-			n[0][0] = a.x; n[0][1] = a.y; n[0][2] = a.z; n[0][3] = a.w;
-			n[1][0] = b.x; n[1][1] = b.y; n[1][2] = b.z; n[1][3] = b.w;
-			n[2][0] = c.x; n[2][1] = c.y; n[2][2] = c.z; n[2][3] = c.w;
-			n[3][0] = d.x; n[3][1] = d.y; n[3][2] = d.z; n[3][3] = d.w;
-		}
-		inline Vec4& operator[](int i) {
-			return (*reinterpret_cast<Vec4*>(n[i]));
+			:n{ Vec4(n00, n01, n02, n03), Vec4(n10, n11, n12, n13), Vec4(n20, n21, n22, n23), Vec4(n30, n31, n32, n33) }
+		{};
+		constexpr Mat4(const Vec4& a, const Vec4& b, const Vec4& c, const Vec4& d)
+			:n{ a, b, c, d }
+		{}
+		constexpr Vec4& operator[](int i) {
+			return n[i];
 		}
-		inline const Vec4& operator[](int i) const{
-			return (*reinterpret_cast<const Vec4*>(n[i]));
+		constexpr const Vec4& operator[](int i) const{
+			return n[i];
 		}
-		inline friend Vec4 operator * (const Mat4& m, const Vec4& v) {
-			return Vec4(
-				m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0] * v.w,
-				m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1] * v.w,
-				m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z + m[3][2] * v.w,
-				m[0][3] * v.x + m[1][3] * v.y + m[2][3] * v.z + m[3][3] * v.w
-			);
+	};
+	//Scalar reference implementations. Always available, used when no SIMD backend is enabled
+	//and as the ground truth the SIMD versions are checked against.
+	constexpr Vec4 MulScalar(const Mat4& m, const Vec4& v) {
+		return Vec4(
+			m[0].x * v.x + m[1].x * v.y + m[2].x * v.z + m[3].x * v.w,
+			m[0].y * v.x + m[1].y * v.y + m[2].y * v.z + m[3].y * v.w,
+			m[0].z * v.x + m[1].z * v.y + m[2].z * v.z + m[3].z * v.w,
+			m[0].w * v.x + m[1].w * v.y + m[2].w * v.z + m[3].w * v.w
+		);
+	}
+	constexpr Mat4 MulScalar(const Mat4& l, const Mat4& r) {
+		//Each result column is l * that column of r
+		return Mat4(MulScalar(l, r[0]), MulScalar(l, r[1]), MulScalar(l, r[2]), MulScalar(l, r[3]));
+	}
+#if defined(EW_SIMD)
+	//SIMD implementations. Each result column is a linear combination of the columns of the left matrix,
+	//summed in the same order as the scalar path (mul + add, no fused multiply-add), so results are bit-exact.
+	//Compilers that contract multiply-adds into FMAs (-ffp-contract=fast where FMA is available, the default on AArch64)
+	//may do so differently for the two paths, which leaves them a few rounding steps apart. tests/ewmath_test checks both cases.
+	inline Vec4 MulSimd(const Mat4& m, const Vec4& v) {
+		simd::float4 x = simd::Load(&v.x);
+		simd::float4 c = simd::Mul(simd::Load(&m[0][0]), simd::SplatLane<0>(x));
+		c = simd::Add(c, simd::Mul(simd::Load(&m[1][0]), simd::SplatLane<1>(x)));
+		c = simd::Add(c, simd::Mul(simd::Load(&m[2][0]), simd::SplatLane<2>(x)));
+		c = simd::Add(c, simd::Mul(simd::Load(&m[3][0]), simd::SplatLane<3>(x)));
+		Vec4 out;
+		simd::Store(&out.x, c);
+		return out;
+	}
+	inline Mat4 MulSimd(const Mat4& l, const Mat4& r) {
+		Mat4 m;
+#if defined(EW_SIMD_AVX)
+		//Two result columns per iteration. Shuffles stay within each 128 bit half, so each half splats its own column of r.
+		const __m256 l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&l[0][0]));
+		const __m256 l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&l[1][0]));
+		const __m256 l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&l[2][0]));
+		const __m256 l3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&l[3][0]));
+		for (int i = 0; i < 4; i += 2)
+		{
+			__m256 rc = _mm256_loadu_ps(&r[i][0]);
+			__m256 c = _mm256_mul_ps(l0, _mm256_shuffle_ps(rc, rc, _MM_SHUFFLE(0, 0, 0, 0)));
+			c = _mm256_add_ps(c, _mm256_mul_ps(l1, _mm256_shuffle_ps(rc, rc, _MM_SHUFFLE(1, 1, 1, 1))));
+			c = _mm256_add_ps(c, _mm256_mul_ps(l2, _mm256_shuffle_ps(rc, rc, _MM_SHUFFLE(2, 2, 2, 2))));
+			c = _mm256_add_ps(c, _mm256_mul_ps(l3, _mm256_shuffle_ps(rc, rc, _MM_SHUFFLE(3, 3, 3, 3))));
+			_mm256_storeu_ps(&m[i][0], c);
 		}
-		inline friend Mat4 operator * (const Mat4& l, const Mat4& r) {
-			Mat4 m;
-			//Row 0
-			m[0][0] = l[0][0] * r[0][0] + l[1][0] * r[0][1] + l[2][0] * r[0][2] + l[3][0] * r[0][3];//dot(l_row_0,r_col_0)
-			m[1][0] = l[0][0] * r[1][0] + l[1][0] * r[1][1] + l[2][0] * r[1][2] + l[3][0] * r[1][3];//dot(l_row_0,r_col_1)
-			m[2][0] = l[0][0] * r[2][0] + l[1][0] * r[2][1] + l[2][0] * r[2][2] + l[3][0] * r[2][3];//dot(l_row_0,r_col_2)
-			m[3][0] = l[0][0] * r[3][0] + l[1][0] * r[3][1] + l[2][0] * r[3][2] + l[3][0] * r[3][3];//dot(l_row_0,r_col_3)
-			// Row 1		  		    		  		    		  		    		  
-			m[0][1] = l[0][1] * r[0][0] + l[1][1] * r[0][1] + l[2][1] * r[0][2] + l[3][1] * r[0][3];//dot(l_row_1,r_col_0)
-			m[1][1] = l[0][1] * r[1][0] + l[1][1] * r[1][1] + l[2][1] * r[1][2] + l[3][1] * r[1][3];//dot(l_row_1,r_col_1)
-			m[2][1] = l[0][1] * r[2][0] + l[1][1] * r[2][1] + l[2][1] * r[2][2] + l[3][1] * r[2][3];//dot(l_row_1,r_col_2)
-			m[3][1] = l[0][1] * r[3][0] + l[1][1] * r[3][1] + l[2][1] * r[3][2] + l[3][1] * r[3][3];//dot(l_row_1,r_col_3)
-			// Row  2		  		    		  		    		  		    		  
-			m[0][2] = l[0][2] * r[0][0] + l[1][2] * r[0][1] + l[2][2] * r[0][2] + l[3][2] * r[0][3];//dot(l_row_2,r_col_0)
-			m[1][2] = l[0][2] * r[1][0] + l[1][2] * r[1][1] + l[2][2] * r[1][2] + l[3][2] * r[1][3];//dot(l_row_2,r_col_1)
-			m[2][2] = l[0][2] * r[2][0] + l[1][2] * r[2][1] + l[2][2] * r[2][2] + l[3][2] * r[2][3];//dot(l_row_2,r_col_2)
-			m[3][2] = l[0][2] * r[3][0] + l[1][2] * r[3][1] + l[2][2] * r[3][2] + l[3][2] * r[3][3];//dot(l_row_2,r_col_3)
-			// Row  3		 			 		 			 		 			 		    
-			m[0][3] = l[0][3] * r[0][0] + l[1][3] * r[0][1] + l[2][3] * r[0][2] + l[3][3] * r[0][3];//dot(l_row_3,r_col_0)
-			m[1][3] = l[0][3] * r[1][0] + l[1][3] * r[1][1] + l[2][3] * r[1][2] + l[3][3] * r[1][3];//dot(l_row_3,r_col_1)
-			m[2][3] = l[0][3] * r[2][0] + l[1][3] * r[2][1] + l[2][3] * r[2][2] + l[3][3] * r[2][3];//dot(l_row_3,r_col_2)
-			m[3][3] = l[0][3] * r[3][0] + l[1][3] * r[3][1] + l[2][3] * r[3][2] + l[3][3] * r[3][3];//dot(l_row_3,r_col_3)
-			return m;		  
+#else
+		const simd::float4 l0 = simd::Load(&l[0][0]);
+		const simd::float4 l1 = simd::Load(&l[1][0]);
+		const simd::float4 l2 = simd::Load(&l[2][0]);
+		const simd::float4 l3 = simd::Load(&l[3][0]);
+		for (int i = 0; i < 4; i++)
+		{
+			simd::float4 rc = simd::Load(&r[i][0]);
+			simd::float4 c = simd::Mul(l0, simd::SplatLane<0>(rc));
+			c = simd::Add(c, simd::Mul(l1, simd::SplatLane<1>(rc)));
+			c = simd::Add(c, simd::Mul(l2, simd::SplatLane<2>(rc)));
+			c = simd::Add(c, simd::Mul(l3, simd::SplatLane<3>(rc)));
+			simd::Store(&m[i][0], c);
 		}
-	};
-	inline Mat4 IdentityMatrix() {
+#endif
+		return m;
+	}
+#endif
+	//With SIMD enabled the operators only stay usable in constant expressions when the compiler can tell
+	//constant evaluation apart from runtime (EW_IS_CONSTANT_EVALUATED), in which case the scalar path is used at compile time.
+	EW_SIMD_CONSTEXPR Vec4 operator * (const Mat4& m, const Vec4& v) {
+#if defined(EW_SIMD)
+#if defined(EW_IS_CONSTANT_EVALUATED)
+		if (EW_IS_CONSTANT_EVALUATED())
+			return MulScalar(m, v);
+#endif
+		return MulSimd(m, v);
+#else
+		return MulScalar(m, v);
+#endif
+	}
+	EW_SIMD_CONSTEXPR Mat4 operator * (const Mat4& l, const Mat4& r) {
+#if defined(EW_SIMD)
+#if defined(EW_IS_CONSTANT_EVALUATED)
+		if (EW_IS_CONSTANT_EVALUATED())
+			return MulScalar(l, r);
+#endif
+		return MulSimd(l, r);
+#else
+		return MulScalar(l, r);
+#endif
+	}
+	constexpr Mat4 IdentityMatrix() {
 		return Mat4(
 			1.0f, 0.0f, 0.0f, 0.0f,
 			0.0f, 1.0f, 0.0f, 0.0f,
@@ -82,4 +128,65 @@ namespace ew {
 			0.0f, 0.0f, 0.0f, 1.0f
 		);
 	}
+	constexpr Mat4 Transpose(const Mat4& m) {
+		//Columns of m become rows
+		return Mat4(
+			m[0].x, m[0].y, m[0].z, m[0].w,
+			m[1].x, m[1].y, m[1].z, m[1].w,
+			m[2].x, m[2].y, m[2].z, m[2].w,
+			m[3].x, m[3].y, m[3].z, m[3].w
+		);
+	}
+	//General 4x4 inverse by cofactor expansion over 2x2 minors. Returns identity if m is singular.
+	//Works on any matrix (projections included). Prefer ew::Inverse(Affine3x4) or ew::InverseTRS for model/view matrices, which are much cheaper
+	constexpr Mat4 Inverse(const Mat4& m) {
+		//Treats the storage as a row major matrix a. inverse(transpose(a)) == transpose(inverse(a)),
+		//so writing the result back the same way gives the inverse of m
+		const float a00 = m[0].x, a01 = m[0].y, a02 = m[0].z, a03 = m[0].w;
+		const float a10 = m[1].x, a11 = m[1].y, a12 = m[1].z, a13 = m[1].w;
+		const float a20 = m[2].x, a21 = m[2].y, a22 = m[2].z, a23 = m[2].w;
+		const float a30 = m[3].x, a31 = m[3].y, a32 = m[3].z, a33 = m[3].w;
+
+		const float s0 = a00 * a11 - a10 * a01;
+		const float s1 = a00 * a12 - a10 * a02;
+		const float s2 = a00 * a13 - a10 * a03;
+		const float s3 = a01 * a12 - a11 * a02;
+		const float s4 = a01 * a13 - a11 * a03;
+		const float s5 = a02 * a13 - a12 * a03;
+
+		const float c5 = a22 * a33 - a32 * a23;
+		const float c4 = a21 * a33 - a31 * a23;
+		const float c3 = a21 * a32 - a31 * a22;
+		const float c2 = a20 * a33 - a30 * a23;
+		const float c1 = a20 * a32 - a30 * a22;
+		const float c0 = a20 * a31 - a30 * a21;
+
+		const float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		if (det == 0)
+			return IdentityMatrix();
+		const float invDet = 1.0f / det;
+
+		return Mat4(
+			Vec4(
+				(a11 * c5 - a12 * c4 + a13 * c3) * invDet,
+				(-a01 * c5 + a02 * c4 - a03 * c3) * invDet,
+				(a31 * s5 - a32 * s4 + a33 * s3) * invDet,
+				(-a21 * s5 + a22 * s4 - a23 * s3) * invDet),
+			Vec4(
+				(-a10 * c5 + a12 * c2 - a13 * c1) * invDet,
+				(a00 * c5 - a02 * c2 + a03 * c1) * invDet,
+				(-a30 * s5 + a32 * s2 - a33 * s1) * invDet,
+				(a20 * s5 - a22 * s2 + a23 * s1) * invDet),
+			Vec4(
+				(a10 * c4 - a11 * c2 + a13 * c0) * invDet,
+				(-a00 * c4 + a01 * c2 - a03 * c0) * invDet,
+				(a30 * s4 - a31 * s2 + a33 * s0) * invDet,
+				(-a20 * s4 + a21 * s2 - a23 * s0) * invDet),
+			Vec4(
+				(-a10 * c3 + a11 * c1 - a12 * c0) * invDet,
+				(a00 * c3 - a01 * c1 + a02 * c0) * invDet,
+				(-a30 * s3 + a31 * s1 - a32 * s0) * invDet,
+				(a20 * s3 - a21 * s1 + a22 * s0) * invDet)
+		);
+	}
 }
@@ -0,0 +1,108 @@
+#pragma once
+#include <math.h>
+#include "vec3.h"
+#include "mat4.h"
+
+namespace ew {
+	//Rotation quaternion. (x,y,z) is the vector part, w the scalar part. Defaults to identity
+	struct Quat {
+		float x, y, z, w;
+
+		constexpr Quat() :x(0), y(0), z(0), w(1) {};
+		constexpr Quat(float x, float y, float z, float w) :x(x), y(y), z(z), w(w) {};
+	};
+
+	//Hamilton product. a * b rotates by b first, then a
+	constexpr Quat operator*(const Quat& a, const Quat& b) {
+		return Quat(
+			a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+			a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+			a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+			a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+		);
+	}
+	constexpr Quat operator*(const Quat& q, float s) {
+		return Quat(q.x * s, q.y * s, q.z * s, q.w * s);
+	}
+	constexpr Quat operator+(const Quat& a, const Quat& b) {
+		return Quat(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);
+	}
+	constexpr Quat operator-(const Quat& q) {
+		return Quat(-q.x, -q.y, -q.z, -q.w);
+	}
+
+	constexpr float Dot(const Quat& a, const Quat& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	}
+	inline Quat Normalize(const Quat& q) {
+		float mag = sqrtf(Dot(q, q));
+		if (mag == 0)
+			return Quat();
+		return q * (1.0f / mag);
+	}
+	//Inverse of a unit quaternion
+	constexpr Quat Conjugate(const Quat& q) {
+		return Quat(-q.x, -q.y, -q.z, q.w);
+	}
+
+	//Rotation of rad radians around a normalized axis
+	inline Quat AngleAxis(float rad, const Vec3& axis) {
+		const float s = sinf(rad * 0.5f);
+		return Quat(axis.x * s, axis.y * s, axis.z * s, cosf(rad * 0.5f));
+	}
+	//Same rotation as RotateY(r.y) * RotateX(r.x) * RotateZ(r.z). r is Euler angles in radians
+	inline Quat EulerToQuat(const Vec3& r) {
+		const float sx = sinf(r.x * 0.5f), cx = cosf(r.x * 0.5f);
+		const float sy = sinf(r.y * 0.5f), cy = cosf(r.y * 0.5f);
+		const float sz = sinf(r.z * 0.5f), cz = cosf(r.z * 0.5f);
+		return Quat(
+			cy * sx * cz + sy * cx * sz,
+			sy * cx * cz - cy * sx * sz,
+			cy * cx * sz - sy * sx * cz,
+			cy * cx * cz + sy * sx * sz
+		);
+	}
+
+	//Rotates v by unit quaternion q
+	constexpr Vec3 Rotate(const Quat& q, const Vec3& v) {
+		const Vec3 u = Vec3(q.x, q.y, q.z);
+		const Vec3 t = Cross(u, v) * 2.0f;
+		return v + t * q.w + Cross(u, t);
+	}
+
+	//Translate(t) * rotation(q) * Scale(s) for a unit quaternion. No trig
+	constexpr Mat4 TRS(const Vec3& t, const Quat& q, const Vec3& s) {
+		const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		return Mat4(
+			(1.0f - 2.0f * (yy + zz)) * s.x, (2.0f * (xy - wz)) * s.y, (2.0f * (xz + wy)) * s.z, t.x,
+			(2.0f * (xy + wz)) * s.x, (1.0f - 2.0f * (xx + zz)) * s.y, (2.0f * (yz - wx)) * s.z, t.y,
+			(2.0f * (xz - wy)) * s.x, (2.0f * (yz + wx)) * s.y, (1.0f - 2.0f * (xx + yy)) * s.z, t.z,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+	//Rotation matrix of a unit quaternion
+	constexpr Mat4 QuatToMat4(const Quat& q) {
+		return TRS(Vec3(0.0f), q, Vec3(1.0f));
+	}
+
+	//Normalized linear interpolation along the shortest path. No trig, constant cost.
+	//Angular speed is not constant, but is close for small angles (typical per-frame animation steps)
+	inline Quat Nlerp(const Quat& a, const Quat& b, float t) {
+		const Quat to = Dot(a, b) < 0 ? -b : b;
+		return Normalize(a * (1.0f - t) + to * t);
+	}
+	//Spherical interpolation along the shortest path with constant angular speed.
+	//Falls back to Nlerp when a and b are nearly equal, where slerp is numerically unstable
+	inline Quat Slerp(const Quat& a, const Quat& b, float t) {
+		float cosTheta = Dot(a, b);
+		const Quat to = cosTheta < 0 ? -b : b;
+		cosTheta = fabsf(cosTheta);
+		if (cosTheta > 0.9995f)
+			return Nlerp(a, to, t);
+		const float theta = acosf(cosTheta);
+		const float invSin = 1.0f / sinf(theta);
+		return a * (sinf((1.0f - t) * theta) * invSin) + to * (sinf(t * theta) * invSin);
+	}
+}
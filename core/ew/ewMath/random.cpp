@@ -0,0 +1,22 @@
+#include "random.h"
+#include "../jobs.h"
+
+namespace ew {
+	constexpr uint64_t Random::DEFAULT_SEED;
+
+	//Values per stream in FillRandom. Part of the output format: changing it changes the numbers for a given seed
+	static const size_t FILL_BLOCK_SIZE = 4096;
+
+	void FillRandom(float* out, size_t count, float min, float max, uint64_t seed, int maxThreads) {
+		size_t numBlocks = (count + FILL_BLOCK_SIZE - 1) / FILL_BLOCK_SIZE;
+		parallelFor(numBlocks, 4, [&](size_t begin, size_t end) {
+			for (size_t block = begin; block < end; block++)
+			{
+				size_t start = block * FILL_BLOCK_SIZE;
+				size_t blockCount = count - start < FILL_BLOCK_SIZE ? count - start : FILL_BLOCK_SIZE;
+				Random random(seed, block);
+				random.fill(out + start, blockCount, min, max);
+			}
+		}, maxThreads);
+	}
+}
@@ -0,0 +1,133 @@
+/*
+	Seedable pseudo random numbers (xoshiro128**, Blackman & Vigna).
+	Small state (16 bytes), no locking and no global state, unlike rand(). Not suitable for cryptography.
+
+	Each ew::Random is independent, so give every thread/job its own:
+		ew::ThreadRandom()           - lazily created generator owned by the calling thread
+		ew::Random(seed, stream)     - deterministic generator. Different streams with the same seed give unrelated sequences,
+		                               so using e.g. a chunk or particle index as the stream keeps results independent of which thread runs it
+*/
+
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+#include <atomic>
+#include "vec2.h"
+#include "vec3.h"
+
+namespace ew {
+	class Random {
+	public:
+		Random(uint64_t seed = DEFAULT_SEED, uint64_t stream = 0) {
+			setSeed(seed, stream);
+		}
+		//Restarts the sequence. The state is expanded from seed and stream with SplitMix64, so similar seeds still give unrelated sequences
+		void setSeed(uint64_t seed, uint64_t stream = 0) {
+			uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+			for (int i = 0; i < 4; i += 2)
+			{
+				uint64_t z = splitMix64(x);
+				m_state[i] = (uint32_t)z;
+				m_state[i + 1] = (uint32_t)(z >> 32);
+			}
+			//All zero is the one state xoshiro can't leave
+			if ((m_state[0] | m_state[1] | m_state[2] | m_state[3]) == 0)
+				m_state[0] = 1;
+		}
+		//Uniform 32 bit integer
+		inline uint32_t nextUInt() {
+			const uint32_t result = rotl(m_state[1] * 5, 7) * 9;
+			const uint32_t t = m_state[1] << 9;
+			m_state[2] ^= m_state[0];
+			m_state[3] ^= m_state[1];
+			m_state[1] ^= m_state[2];
+			m_state[0] ^= m_state[3];
+			m_state[2] ^= t;
+			m_state[3] = rotl(m_state[3], 11);
+			return result;
+		}
+		//Uniform in [0, 1). Uses the top 24 bits, so every value is exactly representable
+		inline float nextFloat() {
+			return (nextUInt() >> 8) * (1.0f / 16777216.0f);
+		}
+		//Uniform in [min, max)
+		inline float range(float min, float max) {
+			return min + (max - min) * nextFloat();
+		}
+		//Uniform integer in [min, max]. Bias is below 2^-32 * (max - min + 1), negligible for anything but huge ranges
+		inline int rangeInt(int min, int max) {
+			uint64_t span = (uint64_t)((int64_t)max - min) + 1;
+			return (int)(min + (int64_t)((nextUInt() * span) >> 32));
+		}
+		//Component wise range
+		inline ew::Vec2 range(const ew::Vec2& min, const ew::Vec2& max) {
+			float x = range(min.x, max.x);
+			return ew::Vec2(x, range(min.y, max.y));
+		}
+		inline ew::Vec3 range(const ew::Vec3& min, const ew::Vec3& max) {
+			float x = range(min.x, max.x);
+			float y = range(min.y, max.y);
+			return ew::Vec3(x, y, range(min.z, max.z));
+		}
+		//Fills out with count values in [min, max). Same values as calling range() count times
+		void fill(float* out, size_t count, float min, float max) {
+			const float scale = (max - min) * (1.0f / 16777216.0f);
+			for (size_t i = 0; i < count; i++)
+			{
+				out[i] = min + (float)(nextUInt() >> 8) * scale;
+			}
+		}
+		void fill(std::vector<float>& out, float min, float max) {
+			fill(out.data(), out.size(), min, max);
+		}
+		//Advances the sequence by 2^64 values. Calling it n times gives n non overlapping subsequences of one seed
+		void jump() {
+			static const uint32_t JUMP[] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+			uint32_t s[4] = { 0, 0, 0, 0 };
+			for (int i = 0; i < 4; i++)
+			{
+				for (int b = 0; b < 32; b++)
+				{
+					if (JUMP[i] & (1u << b)) {
+						for (int j = 0; j < 4; j++)
+							s[j] ^= m_state[j];
+					}
+					nextUInt();
+				}
+			}
+			for (int j = 0; j < 4; j++)
+				m_state[j] = s[j];
+		}
+
+		static constexpr uint64_t DEFAULT_SEED = 0x853c49e6748fea9bull;
+	private:
+		static inline uint32_t rotl(uint32_t x, int k) {
+			return (x << k) | (x >> (32 - k));
+		}
+		static inline uint64_t splitMix64(uint64_t& x) {
+			uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+		uint32_t m_state[4];
+	};
+
+	/// <summary>
+	/// Generator owned by the calling thread. Threads get streams 0, 1, 2... of Random::DEFAULT_SEED in the order they first call this,
+	/// so a single threaded program is reproducible. Reseed with ThreadRandom().setSeed() for per thread control
+	/// </summary>
+	inline Random& ThreadRandom() {
+		static std::atomic<uint64_t> nextStream{ 0 };
+		thread_local Random random(Random::DEFAULT_SEED, nextStream++);
+		return random;
+	}
+
+	/// <summary>
+	/// Fills out with count values in [min, max) using the job threads.
+	/// Output only depends on seed (fixed size blocks each use their own stream), not on the number of threads
+	/// </summary>
+	/// <param name="maxThreads">1 = calling thread only, <= 0 = all job threads</param>
+	void FillRandom(float* out, size_t count, float min, float max, uint64_t seed, int maxThreads = 0);
+}
@@ -0,0 +1,165 @@
+/*
+	Thin wrapper over the platform SIMD intrinsics used by ewMath.
+	The backend is picked at compile time:
+		EW_SIMD_SSE  - x86/x64 with SSE2 (always on for x64)
+		EW_SIMD_AVX  - additionally set when compiling with AVX enabled (/arch:AVX, -mavx)
+		EW_SIMD_NEON - ARM with NEON
+	Define EW_NO_SIMD before including any ewMath header (or project wide) to force the scalar reference path.
+*/
+
+#pragma once
+
+#if !defined(EW_NO_SIMD)
+	#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+		#include <arm_neon.h>
+		#define EW_SIMD_NEON 1
+	#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define EW_SIMD_SSE 1
+		#if defined(__AVX__)
+			#include <immintrin.h>
+			#define EW_SIMD_AVX 1
+		#endif
+	#endif
+#endif
+
+#if defined(EW_SIMD_SSE) || defined(EW_SIMD_NEON)
+	#define EW_SIMD 1
+#endif
+
+//Functions with a SIMD path can still be constexpr if the compiler can tell constant evaluation apart from runtime.
+//Constant evaluation then takes the scalar path: if (EW_IS_CONSTANT_EVALUATED()) return scalar;
+#if defined(__has_builtin)
+	#if __has_builtin(__builtin_is_constant_evaluated)
+		#define EW_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+	#endif
+#endif
+#if !defined(EW_IS_CONSTANT_EVALUATED) && ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+	#define EW_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+//constexpr for functions that dispatch to SIMD, when that is possible
+#if !defined(EW_SIMD) || defined(EW_IS_CONSTANT_EVALUATED)
+	#define EW_SIMD_CONSTEXPR constexpr
+#else
+	#define EW_SIMD_CONSTEXPR inline
+#endif
+
+#if defined(EW_SIMD)
+namespace ew {
+	namespace simd {
+		//4 wide float register. All loads/stores are unaligned so any float* is valid.
+#if defined(EW_SIMD_SSE)
+		typedef __m128 float4;
+
+		inline float4 Load(const float* p) { return _mm_loadu_ps(p); }
+		inline void Store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+		inline float4 Splat(float x) { return _mm_set1_ps(x); }
+		inline float4 Add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+		inline float4 Sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+		inline float4 Mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+		inline float4 Div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+		inline float4 Min(float4 a, float4 b) { return _mm_min_ps(a, b); }
+		inline float4 Max(float4 a, float4 b) { return _mm_max_ps(a, b); }
+		//Comparisons return all bits set in lanes where the comparison holds
+		inline float4 CmpGe(float4 a, float4 b) { return _mm_cmpge_ps(a, b); }
+		inline float4 And(float4 a, float4 b) { return _mm_and_ps(a, b); }
+		//Bit k is set if lane k has its sign (top) bit set, e.g. a comparison result
+		inline int MoveMask(float4 v) { return _mm_movemask_ps(v); }
+		//Per lane mask ? a : b
+		inline float4 Select(float4 mask, float4 a, float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		//Round to nearest integer (ties to even). Valid for |v| < 2^31
+		inline float4 Round(float4 v) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(v)); }
+		//Broadcasts lane i of v to all 4 lanes
+		template<int i>
+		inline float4 SplatLane(float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i)); }
+		//Transposes 4 registers treated as rows of a 4x4 matrix
+		inline void Transpose(float4& a, float4& b, float4& c, float4& d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+
+		//4 wide int32 register, for integer work (e.g. hashing) next to float4. Arithmetic wraps like uint32_t
+		typedef __m128i int4;
+
+		inline int4 SplatInt(int x) { return _mm_set1_epi32(x); }
+		inline int4 Add(int4 a, int4 b) { return _mm_add_epi32(a, b); }
+		inline int4 And(int4 a, int4 b) { return _mm_and_si128(a, b); }
+		inline int4 Xor(int4 a, int4 b) { return _mm_xor_si128(a, b); }
+		template<int n>
+		inline int4 ShiftLeft(int4 v) { return _mm_slli_epi32(v, n); }
+		//Shifts in zeros, as for uint32_t
+		template<int n>
+		inline int4 ShiftRight(int4 v) { return _mm_srli_epi32(v, n); }
+		//Truncates toward zero. Valid for |v| < 2^31
+		inline int4 ToInt(float4 v) { return _mm_cvttps_epi32(v); }
+		inline float4 ToFloat(int4 v) { return _mm_cvtepi32_ps(v); }
+#elif defined(EW_SIMD_NEON)
+		typedef float32x4_t float4;
+
+		inline float4 Load(const float* p) { return vld1q_f32(p); }
+		inline void Store(float* p, float4 v) { vst1q_f32(p, v); }
+		inline float4 Splat(float x) { return vdupq_n_f32(x); }
+		inline float4 Add(float4 a, float4 b) { return vaddq_f32(a, b); }
+		inline float4 Sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+		//Separate multiply and add (not vfmaq) so results match the scalar path bit for bit
+		inline float4 Mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+		inline float4 Div(float4 a, float4 b) { return vdivq_f32(a, b); }
+#else
+		//ARMv7 has no vector divide. Reciprocal estimate refined by two Newton-Raphson steps (not bit exact with the scalar path)
+		inline float4 Div(float4 a, float4 b) {
+			float4 r = vrecpeq_f32(b);
+			r = vmulq_f32(r, vrecpsq_f32(b, r));
+			r = vmulq_f32(r, vrecpsq_f32(b, r));
+			return vmulq_f32(a, r);
+		}
+#endif
+		inline float4 Min(float4 a, float4 b) { return vminq_f32(a, b); }
+		inline float4 Max(float4 a, float4 b) { return vmaxq_f32(a, b); }
+		inline float4 CmpGe(float4 a, float4 b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+		inline float4 And(float4 a, float4 b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline int MoveMask(float4 v) {
+			const uint32x4_t top = vshrq_n_u32(vreinterpretq_u32_f32(v), 31);
+			return (int)(vgetq_lane_u32(top, 0) | (vgetq_lane_u32(top, 1) << 1) | (vgetq_lane_u32(top, 2) << 2) | (vgetq_lane_u32(top, 3) << 3));
+		}
+		inline float4 Select(float4 mask, float4 a, float4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+		inline float4 Round(float4 v) { return vrndnq_f32(v); }
+#else
+		//Rounds half away from zero, unlike the other backends (ties to even). Only matters for exact .5 inputs
+		inline float4 Round(float4 v) {
+			const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x80000000u));
+			const float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(vdupq_n_f32(0.5f)), sign));
+			return vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(v, half)));
+		}
+#endif
+		template<int i>
+		inline float4 SplatLane(float4 v) { return vdupq_n_f32(vgetq_lane_f32(v, i)); }
+		inline void Transpose(float4& a, float4& b, float4& c, float4& d) {
+			float32x4x2_t ab = vtrnq_f32(a, b);
+			float32x4x2_t cd = vtrnq_f32(c, d);
+			a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+			b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+			c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+			d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+		}
+
+		typedef int32x4_t int4;
+
+		inline int4 SplatInt(int x) { return vdupq_n_s32(x); }
+		inline int4 Add(int4 a, int4 b) { return vaddq_s32(a, b); }
+		inline int4 And(int4 a, int4 b) { return vandq_s32(a, b); }
+		inline int4 Xor(int4 a, int4 b) { return veorq_s32(a, b); }
+		template<int n>
+		inline int4 ShiftLeft(int4 v) { return vshlq_n_s32(v, n); }
+		template<int n>
+		inline int4 ShiftRight(int4 v) { return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(v), n)); }
+		inline int4 ToInt(float4 v) { return vcvtq_s32_f32(v); }
+		inline float4 ToFloat(int4 v) { return vcvtq_f32_s32(v); }
+#endif
+
+		//Round down to an integer. Valid for |v| < 2^31
+		inline float4 Floor(float4 v) {
+			const float4 r = Round(v);
+			return Select(CmpGe(v, r), r, Sub(r, Splat(1.0f)));
+		}
+	}
+}
+#endif
@@ -8,7 +8,7 @@
 
 namespace ew {
 	//Identity matrix
-	inline ew::Mat4 Identity() {
+	constexpr ew::Mat4 Identity() {
 		return ew::Mat4(
 			1, 0, 0, 0,
 			0, 1, 0, 0,
@@ -17,7 +17,7 @@ namespace ew {
 		);
 	};
 	//Scale on x,y,z axes
-	inline ew::Mat4 Scale(const ew::Vec3& s) {
+	constexpr ew::Mat4 Scale(const ew::Vec3& s) {
 		return ew::Mat4(
 			s.x, 0, 0, 0,
 			0, s.y, 0, 0,
@@ -59,7 +59,7 @@ namespace ew {
 		);
 	};
 	//Translate x,y,z
-	inline ew::Mat4 Translate(const ew::Vec3& t) {
+	constexpr ew::Mat4 Translate(const ew::Vec3& t) {
 		return Mat4(
 			1.0f, 0.0f, 0.0f, t.x,
 			0.0f, 1.0f, 0.0f, t.y,
@@ -67,6 +67,24 @@ namespace ew {
 			0.0f, 0.0f, 0.0f, 1.0f
 		);
 	};
+	//Translate(t) * RotateY(r.y) * RotateX(r.x) * RotateZ(r.z) * Scale(s), from the sines and cosines of the Euler angles.
+	//Lets callers supply their own trig (e.g. ew::FastSinCos)
+	constexpr ew::Mat4 TRSSinCos(const ew::Vec3& t, const ew::Vec3& sinR, const ew::Vec3& cosR, const ew::Vec3& s) {
+		const float sx = sinR.x, cx = cosR.x;
+		const float sy = sinR.y, cy = cosR.y;
+		const float sz = sinR.z, cz = cosR.z;
+		return Mat4(
+			(cy * cz + sy * sx * sz) * s.x, (sy * sx * cz - cy * sz) * s.y, (sy * cx) * s.z, t.x,
+			(cx * sz) * s.x, (cx * cz) * s.y, (-sx) * s.z, t.y,
+			(cy * sx * sz - sy * cz) * s.x, (sy * sz + cy * sx * cz) * s.y, (cy * cx) * s.z, t.z,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	};
+	//Translate(t) * RotateY(r.y) * RotateX(r.x) * RotateZ(r.z) * Scale(s), built directly instead of multiplied out.
+	//r is Euler angles in radians
+	inline ew::Mat4 TRS(const ew::Vec3& t, const ew::Vec3& r, const ew::Vec3& s) {
+		return TRSSinCos(t, ew::Vec3(sinf(r.x), sinf(r.y), sinf(r.z)), ew::Vec3(cosf(r.x), cosf(r.y), cosf(r.z)), s);
+	};
 
 	inline ew::Mat4 LookAt(const ew::Vec3& eyePos, const ew::Vec3& targetPos, const ew::Vec3& up) {
 		ew::Vec3 f = ew::Normalize(eyePos - targetPos);
@@ -91,21 +109,18 @@ namespace ew {
 		return m;
 	}
 
-	inline ew::Mat4 Orthographic(float height, float a, float n, float f) {
+	constexpr ew::Mat4 Orthographic(float height, float a, float n, float f) {
 		//Symmetrical bounds based on aspect ratio
-		float t = height / 2;
-		float b = -t;
-		float r = (height * a) / 2;
-		float l = -r;
+		const float t = height / 2;
+		const float b = -t;
+		const float r = (height * a) / 2;
+		const float l = -r;
 
-		Mat4 m = Mat4(0);
-		m[0][0] = 2 / (r - l);
-		m[1][1] = 2 / (t - b);
-		m[2][2] = -2 / (f - n);
-		m[3][0] = -(r + l) / (r - l);
-		m[3][1] = -(t + b) / (t - b);
-		m[3][2] = -(f + n) / (f - n);
-		m[3][3] = 1.0f;
-		return m;
+		return Mat4(
+			2 / (r - l), 0, 0, -(r + l) / (r - l),
+			0, 2 / (t - b), 0, -(t + b) / (t - b),
+			0, 0, -2 / (f - n), -(f + n) / (f - n),
+			0, 0, 0, 1.0f
+		);
 	}
 }
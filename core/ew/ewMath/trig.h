@@ -0,0 +1,144 @@
+/*
+	Fast sine/cosine approximations.
+	x is reduced to [-PI/4, PI/4] around the nearest multiple of PI/2 (3 part Cody-Waite reduction),
+	then low degree minimax polynomials (Cephes sinf/cosf coefficients) are evaluated for both results at once.
+
+	Max absolute error against double precision sin/cos (measured over 2M evenly spaced inputs):
+		|x| <= 8192    9.3e-8 (about 1 ulp near 1.0)
+		|x| <= 1e5     9.6e-7
+	Past that the reduction loses precision quickly, so reduce large angles yourself first.
+	Results can overshoot [-1, 1] by up to the error above.
+	The scalar, 4 wide and 8 wide versions give identical results for the same input, as long as the compiler does not contract
+	multiply-adds into FMAs (ARMv7 NEON may also differ on exact ties).
+*/
+
+#pragma once
+#include <math.h>
+#include <cstddef>
+#include "simd.h"
+
+namespace ew {
+	namespace trig {
+		constexpr float TWO_OVER_PI = 0.636619772367581f;
+		//PI/2 split in 3 parts. The first two have few enough bits that q * part is exact
+		constexpr float PIO2_1 = 1.5703125f;
+		constexpr float PIO2_2 = 4.8375129699707031e-4f;
+		constexpr float PIO2_3 = 7.5497899548918821e-8f;
+		constexpr float S1 = -1.6666654611e-1f;
+		constexpr float S2 = 8.3321608736e-3f;
+		constexpr float S3 = -1.9515295891e-4f;
+		constexpr float C1 = 4.166664568298827e-2f;
+		constexpr float C2 = -1.388731625493765e-3f;
+		constexpr float C3 = 2.443315711809948e-5f;
+	}
+
+	/// <summary>
+	/// Sine and cosine of x (radians) in one call. See the top of trig.h for accuracy
+	/// </summary>
+	inline void FastSinCos(float x, float* sinOut, float* cosOut) {
+		using namespace ew::trig;
+		//Quadrant
+		const float q = rintf(x * TWO_OVER_PI); //Nearest, ties to even like the SIMD versions
+		const float r = ((x - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+		const float z = r * r;
+		const float s = r + r * z * (S1 + z * (S2 + z * S3));
+		const float c = 1.0f - 0.5f * z + z * z * (C1 + z * (C2 + z * C3));
+		//q mod 4 picks which of +-sin(r), +-cos(r) each result is
+		const float q4 = q - 4.0f * floorf(q * 0.25f);
+		const bool swap = q4 == 1.0f || q4 == 3.0f;
+		const float sinR = swap ? c : s;
+		const float cosR = swap ? s : c;
+		*sinOut = q4 >= 2.0f ? -sinR : sinR;
+		*cosOut = (q4 == 1.0f || q4 == 2.0f) ? -cosR : cosR;
+	}
+
+#if defined(EW_SIMD)
+	/// <summary>
+	/// 4 wide FastSinCos. Same operations as the scalar version, lane for lane
+	/// </summary>
+	inline void FastSinCos(simd::float4 x, simd::float4* sinOut, simd::float4* cosOut) {
+		using namespace ew::simd;
+		using namespace ew::trig;
+		const float4 q = Round(Mul(x, Splat(TWO_OVER_PI)));
+		float4 r = Sub(x, Mul(q, Splat(PIO2_1)));
+		r = Sub(r, Mul(q, Splat(PIO2_2)));
+		r = Sub(r, Mul(q, Splat(PIO2_3)));
+		const float4 z = Mul(r, r);
+		float4 s = Add(Splat(S2), Mul(z, Splat(S3)));
+		s = Add(Splat(S1), Mul(z, s));
+		s = Add(r, Mul(Mul(r, z), s));
+		float4 c = Add(Splat(C2), Mul(z, Splat(C3)));
+		c = Add(Splat(C1), Mul(z, c));
+		c = Add(Sub(Splat(1.0f), Mul(Splat(0.5f), z)), Mul(Mul(z, z), c));
+		//q mod 4, then the same quadrant rules as the scalar version. floor(q/4) = round(q/4 - 3/8) since q is an integer
+		const float4 q4 = Sub(q, Mul(Splat(4.0f), Round(Sub(Mul(q, Splat(0.25f)), Splat(0.375f)))));
+		const float4 odd = Sub(q4, Mul(Splat(2.0f), Round(Sub(Mul(q4, Splat(0.5f)), Splat(0.25f)))));
+		const float4 swap = CmpGe(odd, Splat(0.5f));
+		const float4 sinR = Select(swap, c, s);
+		const float4 cosR = Select(swap, s, c);
+		const float4 zero = Splat(0.0f);
+		const float4 sinNeg = CmpGe(q4, Splat(1.5f));
+		const float4 cosNeg = And(CmpGe(q4, Splat(0.5f)), CmpGe(Splat(2.5f), q4));
+		*sinOut = Select(sinNeg, Sub(zero, sinR), sinR);
+		*cosOut = Select(cosNeg, Sub(zero, cosR), cosR);
+	}
+#endif
+
+#if defined(EW_SIMD_AVX)
+	/// <summary>
+	/// 8 wide FastSinCos for AVX builds
+	/// </summary>
+	inline void FastSinCos(__m256 x, __m256* sinOut, __m256* cosOut) {
+		using namespace ew::trig;
+		const __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		__m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(PIO2_1)));
+		r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(PIO2_2)));
+		r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(PIO2_3)));
+		const __m256 z = _mm256_mul_ps(r, r);
+		__m256 s = _mm256_add_ps(_mm256_set1_ps(S2), _mm256_mul_ps(z, _mm256_set1_ps(S3)));
+		s = _mm256_add_ps(_mm256_set1_ps(S1), _mm256_mul_ps(z, s));
+		s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, z), s));
+		__m256 c = _mm256_add_ps(_mm256_set1_ps(C2), _mm256_mul_ps(z, _mm256_set1_ps(C3)));
+		c = _mm256_add_ps(_mm256_set1_ps(C1), _mm256_mul_ps(z, c));
+		c = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), z)), _mm256_mul_ps(_mm256_mul_ps(z, z), c));
+		const __m256 q4 = _mm256_sub_ps(q, _mm256_mul_ps(_mm256_set1_ps(4.0f), _mm256_floor_ps(_mm256_mul_ps(q, _mm256_set1_ps(0.25f)))));
+		const __m256 swap = _mm256_cmp_ps(q4, _mm256_mul_ps(_mm256_set1_ps(2.0f), _mm256_floor_ps(_mm256_mul_ps(q4, _mm256_set1_ps(0.5f)))), _CMP_NEQ_OQ);
+		const __m256 sinR = _mm256_blendv_ps(s, c, swap);
+		const __m256 cosR = _mm256_blendv_ps(c, s, swap);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 sinNeg = _mm256_cmp_ps(q4, _mm256_set1_ps(1.5f), _CMP_GE_OQ);
+		const __m256 cosNeg = _mm256_and_ps(_mm256_cmp_ps(q4, _mm256_set1_ps(0.5f), _CMP_GE_OQ), _mm256_cmp_ps(q4, _mm256_set1_ps(2.5f), _CMP_LE_OQ));
+		*sinOut = _mm256_blendv_ps(sinR, _mm256_sub_ps(zero, sinR), sinNeg);
+		*cosOut = _mm256_blendv_ps(cosR, _mm256_sub_ps(zero, cosR), cosNeg);
+	}
+#endif
+
+	/// <summary>
+	/// FastSinCos over an array, 8 or 4 at a time depending on the SIMD backend. sinOut and cosOut must have room for count floats
+	/// </summary>
+	inline void FastSinCos(const float* x, float* sinOut, float* cosOut, size_t count) {
+		size_t i = 0;
+#if defined(EW_SIMD_AVX)
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 s, c;
+			FastSinCos(_mm256_loadu_ps(x + i), &s, &c);
+			_mm256_storeu_ps(sinOut + i, s);
+			_mm256_storeu_ps(cosOut + i, c);
+		}
+#endif
+#if defined(EW_SIMD)
+		for (; i + 4 <= count; i += 4)
+		{
+			simd::float4 s, c;
+			FastSinCos(simd::Load(x + i), &s, &c);
+			simd::Store(sinOut + i, s);
+			simd::Store(cosOut + i, c);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			FastSinCos(x[i], sinOut + i, cosOut + i);
+		}
+	}
+}
@@ -0,0 +1,240 @@
+#include "frustum.h"
+
+namespace ew {
+	void SphereBatch::clear()
+	{
+		centerX.clear();
+		centerY.clear();
+		centerZ.clear();
+		radius.clear();
+	}
+	void SphereBatch::add(const BoundingSphere& sphere)
+	{
+		centerX.push_back(sphere.center.x);
+		centerY.push_back(sphere.center.y);
+		centerZ.push_back(sphere.center.z);
+		radius.push_back(sphere.radius);
+	}
+	void AABBBatch::clear()
+	{
+		minX.clear();
+		minY.clear();
+		minZ.clear();
+		maxX.clear();
+		maxY.clear();
+		maxZ.clear();
+	}
+	void AABBBatch::add(const AABB& box)
+	{
+		minX.push_back(box.min.x);
+		minY.push_back(box.min.y);
+		minZ.push_back(box.min.z);
+		maxX.push_back(box.max.x);
+		maxY.push_back(box.max.y);
+		maxZ.push_back(box.max.z);
+	}
+
+	/// <summary>
+	/// Each plane is the sum or difference of the last row of the matrix and one of the other rows,
+	/// which is the clip space test -w <= x,y,z <= w moved back into world space. Planes come out in enum order (left, right, bottom, top, near, far).
+	/// </summary>
+	Frustum::Frustum(const ew::Mat4& viewProjection)
+	{
+		const ew::Mat4& m = viewProjection;
+		//Spelled out per component since ew::Vec4 arithmetic leaves w untouched
+		for (int i = 0; i < 3; i++)
+		{
+			const float sign[2] = { 1.0f, -1.0f };
+			for (int j = 0; j < 2; j++)
+			{
+				planes[i * 2 + j] = ew::Vec4(
+					m[0][3] + sign[j] * m[0][i],
+					m[1][3] + sign[j] * m[1][i],
+					m[2][3] + sign[j] * m[2][i],
+					m[3][3] + sign[j] * m[3][i]
+				);
+			}
+		}
+		//Unit normals so plane distances are real distances, needed for the sphere test
+		for (int i = 0; i < 6; i++)
+		{
+			const float len = ew::Magnitude(planes[i].toVec3());
+			if (len > 0)
+			{
+				const float invLen = 1.0f / len;
+				planes[i] = ew::Vec4(planes[i].x * invLen, planes[i].y * invLen, planes[i].z * invLen, planes[i].w * invLen);
+			}
+		}
+	}
+
+	bool Frustum::containsPoint(const ew::Vec3& p) const
+	{
+		return intersects(BoundingSphere{ p, 0.0f });
+	}
+	bool Frustum::intersects(const BoundingSphere& sphere) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			if (ew::Dot(planes[i].toVec3(), sphere.center) + planes[i].w < -sphere.radius)
+				return false;
+		}
+		return true;
+	}
+	/// <summary>
+	/// Tests the corner furthest along each plane normal. If that corner is outside the plane the whole box is.
+	/// </summary>
+	bool Frustum::intersects(const AABB& box) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			const ew::Vec4& p = planes[i];
+			const ew::Vec3 corner = ew::Vec3(
+				p.x >= 0 ? box.max.x : box.min.x,
+				p.y >= 0 ? box.max.y : box.min.y,
+				p.z >= 0 ? box.max.z : box.min.z
+			);
+			if (ew::Dot(p.toVec3(), corner) + p.w < 0)
+				return false;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Appends the lanes set in mask (bit k = index base + k) to out. Always writes 4 slots and advances by the number of set bits,
+	/// so there are no unpredictable branches. Slots past the returned count are overwritten by later calls.
+	/// </summary>
+	static inline size_t appendVisible(int mask, unsigned int base, unsigned int* out, size_t count) {
+		out[count] = base;
+		count += mask & 1;
+		out[count] = base + 1;
+		count += (mask >> 1) & 1;
+		out[count] = base + 2;
+		count += (mask >> 2) & 1;
+		out[count] = base + 3;
+		count += (mask >> 3) & 1;
+		return count;
+	}
+
+	size_t Frustum::cull(const SphereBatch& bounds, unsigned int* visibleOut) const
+	{
+		const size_t n = bounds.size();
+		size_t count = 0;
+		size_t i = 0;
+#if defined(EW_SIMD)
+		using namespace ew::simd;
+		float4 px[6], py[6], pz[6], pw[6];
+		for (int p = 0; p < 6; p++)
+		{
+			px[p] = Splat(planes[p].x);
+			py[p] = Splat(planes[p].y);
+			pz[p] = Splat(planes[p].z);
+			pw[p] = Splat(planes[p].w);
+		}
+		const float4 zero = Splat(0.0f);
+		for (; i + 4 <= n; i += 4)
+		{
+			const float4 cx = Load(&bounds.centerX[i]);
+			const float4 cy = Load(&bounds.centerY[i]);
+			const float4 cz = Load(&bounds.centerZ[i]);
+			const float4 negRadius = Sub(zero, Load(&bounds.radius[i]));
+			float4 inside = CmpGe(zero, zero);
+			for (int p = 0; p < 6; p++)
+			{
+				float4 d = Add(Mul(px[p], cx), Mul(py[p], cy));
+				d = Add(d, Mul(pz[p], cz));
+				d = Add(d, pw[p]);
+				inside = And(inside, CmpGe(d, negRadius));
+			}
+			//count <= i, so the 4 slots written stay inside visibleOut
+			count = appendVisible(MoveMask(inside), (unsigned int)i, visibleOut, count);
+		}
+#endif
+		for (; i < n; i++)
+		{
+			const BoundingSphere sphere = { ew::Vec3(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]), bounds.radius[i] };
+			if (intersects(sphere))
+				visibleOut[count++] = (unsigned int)i;
+		}
+		return count;
+	}
+	/// <summary>
+	/// Same corner test as intersects(AABB). The plane normals are the same for every box, so the corner is picked by
+	/// choosing the min or max array per plane instead of per box.
+	/// </summary>
+	size_t Frustum::cull(const AABBBatch& bounds, unsigned int* visibleOut) const
+	{
+		const size_t n = bounds.size();
+		size_t count = 0;
+		size_t i = 0;
+#if defined(EW_SIMD)
+		using namespace ew::simd;
+		const float* cornerX[6];
+		const float* cornerY[6];
+		const float* cornerZ[6];
+		float4 px[6], py[6], pz[6], pw[6];
+		for (int p = 0; p < 6; p++)
+		{
+			cornerX[p] = planes[p].x >= 0 ? bounds.maxX.data() : bounds.minX.data();
+			cornerY[p] = planes[p].y >= 0 ? bounds.maxY.data() : bounds.minY.data();
+			cornerZ[p] = planes[p].z >= 0 ? bounds.maxZ.data() : bounds.minZ.data();
+			px[p] = Splat(planes[p].x);
+			py[p] = Splat(planes[p].y);
+			pz[p] = Splat(planes[p].z);
+			pw[p] = Splat(planes[p].w);
+		}
+		const float4 zero = Splat(0.0f);
+		for (; i + 4 <= n; i += 4)
+		{
+			float4 inside = CmpGe(zero, zero);
+			for (int p = 0; p < 6; p++)
+			{
+				float4 d = Add(Mul(px[p], Load(cornerX[p] + i)), Mul(py[p], Load(cornerY[p] + i)));
+				d = Add(d, Mul(pz[p], Load(cornerZ[p] + i)));
+				d = Add(d, pw[p]);
+				inside = And(inside, CmpGe(d, zero));
+			}
+			count = appendVisible(MoveMask(inside), (unsigned int)i, visibleOut, count);
+		}
+#endif
+		for (; i < n; i++)
+		{
+			const AABB box = { ew::Vec3(bounds.minX[i], bounds.minY[i], bounds.minZ[i]), ew::Vec3(bounds.maxX[i], bounds.maxY[i], bounds.maxZ[i]) };
+			if (intersects(box))
+				visibleOut[count++] = (unsigned int)i;
+		}
+		return count;
+	}
+	void Frustum::cull(const SphereBatch& bounds, std::vector<unsigned int>& visibleOut) const
+	{
+		visibleOut.resize(bounds.size());
+		visibleOut.resize(cull(bounds, visibleOut.data()));
+	}
+	void Frustum::cull(const AABBBatch& bounds, std::vector<unsigned int>& visibleOut) const
+	{
+		visibleOut.resize(bounds.size());
+		visibleOut.resize(cull(bounds, visibleOut.data()));
+	}
+
+	/// <summary>
+	/// Center is transformed as a point. Each half extent of the result is the sum of the absolute values of the matrix entries in that row
+	/// times the local half extents.
+	/// </summary>
+	AABB TransformAABB(const AABB& box, const ew::Mat4& m)
+	{
+		const ew::Vec3 center = (box.min + box.max) * 0.5f;
+		const ew::Vec3 extents = (box.max - box.min) * 0.5f;
+		const ew::Vec3 worldCenter = (m * ew::Vec4(center.x, center.y, center.z, 1.0f)).toVec3();
+		const ew::Vec3 worldExtents = ew::Vec3(
+			fabsf(m[0][0]) * extents.x + fabsf(m[1][0]) * extents.y + fabsf(m[2][0]) * extents.z,
+			fabsf(m[0][1]) * extents.x + fabsf(m[1][1]) * extents.y + fabsf(m[2][1]) * extents.z,
+			fabsf(m[0][2]) * extents.x + fabsf(m[1][2]) * extents.y + fabsf(m[2][2]) * extents.z
+		);
+		return AABB{ worldCenter - worldExtents, worldCenter + worldExtents };
+	}
+	BoundingSphere TransformSphere(const BoundingSphere& sphere, const ew::Mat4& m)
+	{
+		const ew::Vec3 worldCenter = (m * ew::Vec4(sphere.center.x, sphere.center.y, sphere.center.z, 1.0f)).toVec3();
+		const float scaleSq = fmaxf(ew::Dot(m[0].toVec3(), m[0].toVec3()), fmaxf(ew::Dot(m[1].toVec3(), m[1].toVec3()), ew::Dot(m[2].toVec3(), m[2].toVec3())));
+		return BoundingSphere{ worldCenter, sphere.radius * sqrtf(scaleSq) };
+	}
+}
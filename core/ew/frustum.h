@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include "ewMath/ewMath.h"
+#include "camera.h"
+#include "bounds.h"
+
+namespace ew {
+	//Structure-of-arrays bounds, tested 4 at a time by Frustum::cull
+	struct SphereBatch {
+		std::vector<float> centerX, centerY, centerZ, radius;
+
+		inline size_t size()const { return centerX.size(); }
+		void clear();
+		void add(const BoundingSphere& sphere);
+	};
+	struct AABBBatch {
+		std::vector<float> minX, minY, minZ;
+		std::vector<float> maxX, maxY, maxZ;
+
+		inline size_t size()const { return minX.size(); }
+		void clear();
+		void add(const AABB& box);
+	};
+
+	//View frustum as 6 world space planes, extracted from a view projection matrix (Gribb/Hartmann).
+	//Works for perspective and orthographic projections alike.
+	//Tests are conservative: bounds near a frustum corner may pass even though they are outside, but nothing visible is ever rejected.
+	struct Frustum {
+		enum { LEFT_PLANE, RIGHT_PLANE, BOTTOM_PLANE, TOP_PLANE, NEAR_PLANE, FAR_PLANE };
+		//xyz = normal pointing into the frustum (normalized), w = distance. A point p is inside a plane if dot(normal, p) + w >= 0
+		ew::Vec4 planes[6];
+
+		Frustum() = default;
+		explicit Frustum(const ew::Mat4& viewProjection);
+		explicit Frustum(const Camera& camera) :Frustum(camera.ProjectionMatrix() * camera.ViewMatrix()) {};
+
+		bool containsPoint(const ew::Vec3& p)const;
+		bool intersects(const BoundingSphere& sphere)const;
+		bool intersects(const AABB& box)const;
+
+		//Writes the indices of all bounds that intersect the frustum to visibleOut, in increasing order, and returns how many there are.
+		//visibleOut must have room for bounds.size() indices.
+		size_t cull(const SphereBatch& bounds, unsigned int* visibleOut)const;
+		size_t cull(const AABBBatch& bounds, unsigned int* visibleOut)const;
+		void cull(const SphereBatch& bounds, std::vector<unsigned int>& visibleOut)const;
+		void cull(const AABBBatch& bounds, std::vector<unsigned int>& visibleOut)const;
+	};
+
+	//World space bounds of a transformed box. Result fully encloses the transformed box (Arvo's method)
+	AABB TransformAABB(const AABB& box, const ew::Mat4& m);
+	//Radius is scaled by the largest axis scale, so the result encloses the transformed sphere
+	BoundingSphere TransformSphere(const BoundingSphere& sphere, const ew::Mat4& m);
+}
@@ -0,0 +1,142 @@
+#include "jobs.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ew {
+	namespace {
+		/// <summary>
+		/// Fixed set of worker threads pulling jobs from a single queue. Created on first use and joined at exit.
+		/// </summary>
+		class WorkerPool {
+		public:
+			WorkerPool() {
+				unsigned int hardwareThreads = std::thread::hardware_concurrency();
+				unsigned int numWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+				for (unsigned int i = 0; i < numWorkers; i++)
+				{
+					m_threads.emplace_back(&WorkerPool::workerLoop, this);
+				}
+			}
+			~WorkerPool() {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_quit = true;
+				}
+				m_wake.notify_all();
+				for (std::thread& thread : m_threads) {
+					thread.join();
+				}
+			}
+			int getNumWorkers()const { return (int)m_threads.size(); }
+			void push(std::function<void()> job) {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_jobs.push_back(std::move(job));
+				}
+				m_wake.notify_one();
+			}
+		private:
+			void workerLoop() {
+				while (true) {
+					std::function<void()> job;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_wake.wait(lock, [this] { return m_quit || !m_jobs.empty(); });
+						if (m_quit && m_jobs.empty())
+							return;
+						job = std::move(m_jobs.front());
+						m_jobs.pop_front();
+					}
+					job();
+				}
+			}
+			std::vector<std::thread> m_threads;
+			std::deque<std::function<void()>> m_jobs;
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			bool m_quit = false;
+		};
+
+		WorkerPool& getPool() {
+			static WorkerPool pool;
+			return pool;
+		}
+
+		//Shared between the caller and any workers helping with one parallelFor call
+		struct ParallelForState {
+			const std::function<void(size_t, size_t)>* fn;
+			size_t count;
+			size_t chunkSize;
+			size_t numChunks;
+			std::atomic<size_t> nextChunk{ 0 };
+			std::atomic<size_t> chunksDone{ 0 };
+			std::mutex mutex;
+			std::condition_variable finished;
+
+			//Claims and runs chunks until none are left
+			void run() {
+				size_t chunk;
+				while ((chunk = nextChunk.fetch_add(1)) < numChunks) {
+					size_t begin = chunk * chunkSize;
+					size_t end = std::min(begin + chunkSize, count);
+					(*fn)(begin, end);
+					if (chunksDone.fetch_add(1) + 1 == numChunks) {
+						std::lock_guard<std::mutex> lock(mutex);
+						finished.notify_all();
+					}
+				}
+			}
+		};
+	}
+
+	int getNumJobThreads() {
+		return getPool().getNumWorkers() + 1;
+	}
+
+	/// <summary>
+	/// Runs fn over [0, count) in parallel. Ranges are claimed dynamically, so the caller never waits on a worker
+	/// that has not started yet. This also makes it safe to call parallelFor from inside a job.
+	/// </summary>
+	/// <param name="count">Number of items</param>
+	/// <param name="minChunk">Smallest range handed to a single call of fn</param>
+	/// <param name="fn">Called with [begin, end) item ranges. Must be safe to call concurrently for disjoint ranges.</param>
+	/// <param name="maxThreads">Thread limit. <= 0 for all threads, 1 to run inline</param>
+	void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t begin, size_t end)>& fn, int maxThreads)
+	{
+		if (count == 0)
+			return;
+		int numThreads = getNumJobThreads();
+		if (maxThreads > 0)
+			numThreads = std::min(numThreads, maxThreads);
+		minChunk = std::max<size_t>(minChunk, 1);
+
+		//A few chunks per thread so uneven ranges still balance out
+		size_t numChunks = std::min((count + minChunk - 1) / minChunk, (size_t)numThreads * 4);
+		if (numThreads <= 1 || numChunks <= 1) {
+			fn(0, count);
+			return;
+		}
+
+		std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+		state->fn = &fn;
+		state->count = count;
+		state->chunkSize = (count + numChunks - 1) / numChunks;
+		state->numChunks = (count + state->chunkSize - 1) / state->chunkSize;
+
+		int numHelpers = (int)std::min<size_t>(numThreads - 1, state->numChunks - 1);
+		for (int i = 0; i < numHelpers; i++)
+		{
+			getPool().push([state] { state->run(); });
+		}
+		state->run();
+
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->finished.wait(lock, [&state] { return state->chunksDone.load() == state->numChunks; });
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace ew {
+	//Number of threads parallelFor can run on at once (pool workers + the calling thread)
+	int getNumJobThreads();
+
+	//Splits [0, count) into contiguous ranges of at least minChunk items and calls fn(begin, end) for each,
+	//spread across a persistent worker pool. The calling thread also runs ranges and the call blocks until all are done.
+	//maxThreads limits how many threads take part. <= 0 uses every thread in the pool, 1 runs inline on the caller.
+	void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t begin, size_t end)>& fn, int maxThreads = 0);
+}
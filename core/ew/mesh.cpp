@@ -3,37 +3,182 @@
 */
 
 #include "mesh.h"
+#include "vertexFormat.h"
+#include "meshFile.h"
+#include "jobs.h"
 #include "ewMath/ewMath.h"
 #include "external/glad.h"
+#include <algorithm>
+#include <functional>
 
 namespace ew {
-	Mesh::Mesh(const MeshData& meshData)
+	void MeshData::compactIndices()
 	{
-		load(meshData);
+		if (indices.empty() || vertices.size() > MAX_16BIT_VERTICES)
+			return;
+		indices16.assign(indices.begin(), indices.end());
+		indices.clear();
+		indices.shrink_to_fit();
 	}
-	void Mesh::load(const MeshData& meshData)
+	void MeshData::updateBounds(int maxThreads)
 	{
-		if (!m_initialized) {
-			glGenVertexArrays(1, &m_vao);
-			glBindVertexArray(m_vao);
+		bounds = ComputeBounds(vertices.data(), vertices.size(), maxThreads);
+		hasBounds = true;
+	}
 
-			glGenBuffers(1, &m_vbo);
-			glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	//Vertices per job when scanning bounds
+	static const size_t BOUNDS_CHUNK = 16384;
 
-			glGenBuffers(1, &m_ebo);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-			//Position attribute
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos));
-			glEnableVertexAttribArray(0);
+	/// <summary>
+	/// The SIMD path loads each position as 4 floats. The 4th is normal.x, which is always inside the vertex, and its lane is ignored
+	/// </summary>
+	static AABB scanBox(const Vertex* vertices, size_t count)
+	{
+#if defined(EW_SIMD)
+		using namespace ew::simd;
+		float4 min = Load(&vertices[0].pos.x);
+		float4 max = min;
+		for (size_t i = 1; i < count; i++) {
+			const float4 p = Load(&vertices[i].pos.x);
+			min = Min(min, p);
+			max = Max(max, p);
+		}
+		float minLanes[4], maxLanes[4];
+		Store(minLanes, min);
+		Store(maxLanes, max);
+		return AABB{ Vec3(minLanes[0], minLanes[1], minLanes[2]), Vec3(maxLanes[0], maxLanes[1], maxLanes[2]) };
+#else
+		Vec3 min = vertices[0].pos;
+		Vec3 max = min;
+		for (size_t i = 1; i < count; i++) {
+			const Vec3& p = vertices[i].pos;
+			min = Vec3(fminf(min.x, p.x), fminf(min.y, p.y), fminf(min.z, p.z));
+			max = Vec3(fmaxf(max.x, p.x), fmaxf(max.y, p.y), fmaxf(max.z, p.z));
+		}
+		return AABB{ min, max };
+#endif
+	}
+	/// <summary>
+	/// Largest squared distance from center. The SIMD path transposes 4 positions into x, y and z registers and measures them together
+	/// </summary>
+	static float scanRadiusSquared(const Vertex* vertices, size_t count, const Vec3& center)
+	{
+		float maxSquared = 0.0f;
+		size_t i = 0;
+#if defined(EW_SIMD)
+		using namespace ew::simd;
+		const float4 cx = Splat(center.x);
+		const float4 cy = Splat(center.y);
+		const float4 cz = Splat(center.z);
+		float4 max = Splat(0.0f);
+		for (; i + 4 <= count; i += 4) {
+			float4 x = Load(&vertices[i].pos.x);
+			float4 y = Load(&vertices[i + 1].pos.x);
+			float4 z = Load(&vertices[i + 2].pos.x);
+			float4 w = Load(&vertices[i + 3].pos.x);
+			Transpose(x, y, z, w);
+			const float4 dx = Sub(x, cx);
+			const float4 dy = Sub(y, cy);
+			const float4 dz = Sub(z, cz);
+			max = Max(max, Add(Add(Mul(dx, dx), Mul(dy, dy)), Mul(dz, dz)));
+		}
+		float lanes[4];
+		Store(lanes, max);
+		maxSquared = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+		for (; i < count; i++) {
+			const Vec3 d = vertices[i].pos - center;
+			maxSquared = std::max(maxSquared, d.x * d.x + d.y * d.y + d.z * d.z);
+		}
+		return maxSquared;
+	}
+	/// <summary>
+	/// Two passes over fixed blocks of vertices: each block's box, then, once the center is known, each block's largest distance.
+	/// Blocks don't depend on the thread count, so neither does the result
+	/// </summary>
+	MeshBounds ComputeBounds(const Vertex* vertices, size_t count, int maxThreads)
+	{
+		if (count == 0)
+			return MeshBounds{ AABB{ Vec3(0.0f), Vec3(0.0f) }, BoundingSphere{ Vec3(0.0f), 0.0f } };
+		const size_t numBlocks = (count + BOUNDS_CHUNK - 1) / BOUNDS_CHUNK;
+		auto blockSize = [&](size_t block) {
+			return std::min(BOUNDS_CHUNK, count - block * BOUNDS_CHUNK);
+		};
 
-			//Normal attribute
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, normal));
-			glEnableVertexAttribArray(1);
+		std::vector<AABB> boxes(numBlocks);
+		auto scanBoxes = [&](size_t begin, size_t end) {
+			for (size_t block = begin; block < end; block++) {
+				boxes[block] = scanBox(vertices + block * BOUNDS_CHUNK, blockSize(block));
+			}
+		};
+		parallelFor(numBlocks, 1, std::cref(scanBoxes), maxThreads);
+		AABB box = boxes[0];
+		for (size_t block = 1; block < numBlocks; block++) {
+			box.min = Vec3(fminf(box.min.x, boxes[block].min.x), fminf(box.min.y, boxes[block].min.y), fminf(box.min.z, boxes[block].min.z));
+			box.max = Vec3(fmaxf(box.max.x, boxes[block].max.x), fmaxf(box.max.y, boxes[block].max.y), fmaxf(box.max.z, boxes[block].max.z));
+		}
 
-			//UV attribute
-			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, uv)));
-			glEnableVertexAttribArray(2);
+		const Vec3 center = (box.min + box.max) * 0.5f;
+		std::vector<float> radiiSquared(numBlocks);
+		auto scanRadii = [&](size_t begin, size_t end) {
+			for (size_t block = begin; block < end; block++) {
+				radiiSquared[block] = scanRadiusSquared(vertices + block * BOUNDS_CHUNK, blockSize(block), center);
+			}
+		};
+		parallelFor(numBlocks, 1, std::cref(scanRadii), maxThreads);
+		const float radiusSquared = *std::max_element(radiiSquared.begin(), radiiSquared.end());
+		return MeshBounds{ box, BoundingSphere{ center, sqrtf(radiusSquared) } };
+	}
 
+	Mesh::Mesh(const MeshData& meshData, VertexFormat vertexFormat)
+	{
+		load(meshData, vertexFormat);
+	}
+	void Mesh::load(const MeshData& meshData, VertexFormat vertexFormat)
+	{
+		const size_t numVertices = meshData.vertices.size();
+		m_bounds = meshData.hasBounds ? meshData.bounds : ComputeBounds(meshData.vertices.data(), numVertices);
+		m_positionTransform = ew::AffineIdentity();
+		const void* vertices = meshData.vertices.data();
+		std::vector<PackedVertex> packed;
+		std::vector<QuantizedVertex> quantized;
+		if (vertexFormat == VertexFormat::PACKED) {
+			packed.resize(numVertices);
+			packVertices(meshData.vertices.data(), numVertices, packed.data());
+			vertices = packed.data();
+		}
+		else if (vertexFormat == VertexFormat::QUANTIZED) {
+			quantized.resize(numVertices);
+			m_positionTransform = quantizeVertices(meshData.vertices.data(), numVertices, m_bounds.box, quantized.data());
+			vertices = quantized.data();
+		}
+
+		//Upload 16 bit indices whenever the vertex count allows, converting 32 bit ones if needed
+		if (meshData.has16BitIndices()) {
+			upload(vertexFormat, vertices, numVertices, meshData.indices16.data(), meshData.indices16.size(), true);
+		}
+		else if (numVertices <= MAX_16BIT_VERTICES) {
+			std::vector<unsigned short> indices16(meshData.indices.begin(), meshData.indices.end());
+			upload(vertexFormat, vertices, numVertices, indices16.data(), indices16.size(), true);
+		}
+		else {
+			upload(vertexFormat, vertices, numVertices, meshData.indices.data(), meshData.indices.size(), false);
+		}
+	}
+	void Mesh::load(const MeshFile& file)
+	{
+		const MeshFileHeader& header = file.getHeader();
+		m_bounds = header.bounds;
+		m_positionTransform = header.positionTransform;
+		upload((VertexFormat)header.vertexFormat, file.getVertices(), (size_t)header.numVertices,
+			file.getIndices(), (size_t)header.numIndices, header.indexSize == sizeof(unsigned short));
+	}
+	void Mesh::upload(VertexFormat vertexFormat, const void* vertices, size_t numVertices, const void* indices, size_t numIndices, bool indices16)
+	{
+		if (!m_initialized) {
+			glGenVertexArrays(1, &m_vao);
+			glGenBuffers(1, &m_vbo);
+			glGenBuffers(1, &m_ebo);
 			m_initialized = true;
 		}
 
@@ -41,28 +186,58 @@ namespace ew {
 		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
 
-		if (meshData.vertices.size() > 0) {
-			glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * meshData.vertices.size(), meshData.vertices.data(), GL_STATIC_DRAW);
+		//Attribute formats are set on every load, since the vertex format can change
+		const VertexLayout layout = getVertexLayout(vertexFormat);
+		if (numVertices > 0) {
+			glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(layout.stride * numVertices), vertices, GL_STATIC_DRAW);
 		}
-		if (meshData.indices.size() > 0) {
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * meshData.indices.size(), meshData.indices.data(), GL_STATIC_DRAW);
+		//Position, normal and UV attributes
+		for (GLuint i = 0; i < 3; i++) {
+			const VertexAttribute& attribute = layout.attributes[i];
+			glVertexAttribPointer(i, attribute.components, attribute.type, (GLboolean)attribute.normalized, layout.stride, (const void*)(size_t)attribute.offset);
+			glEnableVertexAttribArray(i);
+		}
+		m_vertexFormat = vertexFormat;
+
+		m_16BitIndices = indices16;
+		if (numIndices > 0) {
+			const size_t indexSize = indices16 ? sizeof(unsigned short) : sizeof(unsigned int);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indexSize * numIndices), indices, GL_STATIC_DRAW);
 		}
-		m_numVertices = meshData.vertices.size();
-		m_numIndices = meshData.indices.size();
+		m_numVertices = (int)numVertices;
+		m_numIndices = (int)numIndices;
 
 		glBindVertexArray(0);
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
+	void Mesh::unload()
+	{
+		if (!m_initialized)
+			return;
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+		glDeleteVertexArrays(1, &m_vao);
+		m_vao = m_vbo = m_ebo = 0;
+		m_numVertices = m_numIndices = 0;
+		m_positionTransform = ew::AffineIdentity();
+		m_initialized = false;
+	}
 	void Mesh::draw(ew::DrawMode drawMode) const
 	{
 		glBindVertexArray(m_vao);
 		if (drawMode == DrawMode::TRIANGLES) {
-			glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, NULL);
+			glDrawElements(GL_TRIANGLES, m_numIndices, m_16BitIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, NULL);
 		}
 		else {
 			glDrawArrays(GL_POINTS, 0, m_numVertices);
 		}
 		
 	}
+	void Mesh::drawRange(size_t firstIndex, size_t numIndices) const
+	{
+		glBindVertexArray(m_vao);
+		const size_t indexSize = m_16BitIndices ? sizeof(unsigned short) : sizeof(unsigned int);
+		glDrawElements(GL_TRIANGLES, (GLsizei)numIndices, m_16BitIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const void*)(firstIndex * indexSize));
+	}
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "ewMath/ewMath.h"
+#include "bounds.h"
 
 namespace ew {
 	struct Vertex {
@@ -12,9 +13,43 @@ namespace ew {
 		ew::Vec2 uv;
 	};
 
+	//Most vertices that 16 bit indices can address
+	constexpr size_t MAX_16BIT_VERTICES = 65536;
+
+	//Only one of indices/indices16 holds the triangles. Generators fill indices16 whenever the vertex count allows it,
+	//which halves index memory; getNumIndices()/getIndex() read whichever is used
 	struct MeshData {
 		std::vector<Vertex> vertices;
 		std::vector<unsigned int> indices;
+		std::vector<unsigned short> indices16;
+		inline bool has16BitIndices()const { return !indices16.empty(); }
+		inline size_t getNumIndices()const { return has16BitIndices() ? indices16.size() : indices.size(); }
+		inline unsigned int getIndex(size_t i)const { return has16BitIndices() ? indices16[i] : indices[i]; }
+		//Moves indices into indices16 if every vertex can be addressed with 16 bits
+		void compactIndices();
+		//Set by the generators from their parameters, so nothing has to scan the vertices for them. Code that moves
+		//vertices must call updateBounds() or clear hasBounds; removing or reordering vertices keeps the bounds valid
+		MeshBounds bounds = {};
+		bool hasBounds = false;
+		//Scans the vertices with ComputeBounds (maxThreads as in procGen)
+		void updateBounds(int maxThreads = 0);
+	};
+
+	//Box and sphere around count vertices, with the sphere centered on the box. The scan is vectorized and split
+	//across the job threads for large meshes (maxThreads as in procGen). No vertices gives bounds of size 0 at the origin
+	MeshBounds ComputeBounds(const Vertex* vertices, size_t count, int maxThreads = 0);
+
+	//Exact number of vertices and indices a generator will write, so buffers can be sized before generating
+	struct MeshSize {
+		size_t numVertices;
+		size_t numIndices;
+	};
+
+	//Vertex layout a Mesh uploads. The shader inputs stay the same (vec3 position, vec3 normal, vec2 uv) for all of them
+	enum class VertexFormat {
+		FLOAT = 0, //ew::Vertex as is, 32 bytes
+		PACKED = 1, //Float position, 10:10:10 normal, half float UV. 20 bytes, see ew::PackedVertex
+		QUANTIZED = 2 //Like PACKED but positions are int16 within the mesh bounds. 16 bytes. Needs getPositionTransform() in the model matrix
 	};
 
 	enum class DrawMode {
@@ -22,20 +57,44 @@ namespace ew {
 		POINTS = 1
 	};
 
+	class MeshFile;
+
 	class Mesh {
 	public:
 		Mesh() {};
-		Mesh(const MeshData& meshData);
-		void load(const MeshData& meshData);
+		Mesh(const MeshData& meshData, VertexFormat vertexFormat = VertexFormat::FLOAT);
+		void load(const MeshData& meshData, VertexFormat vertexFormat = VertexFormat::FLOAT);
+		//Uploads an open mesh file straight from its mapped memory, in the vertex format it was written with.
+		//The file can be closed once this returns
+		void load(const MeshFile& file);
+		//Deletes the GPU buffers. Meshes don't free them on destruction, so call this when a mesh is no longer needed. load() can be called again afterwards
+		void unload();
 		void draw(DrawMode drawMode = DrawMode::TRIANGLES)const;
+		//Draws numIndices indices as triangles, starting at firstIndex (e.g. one or more meshlets)
+		void drawRange(size_t firstIndex, size_t numIndices)const;
 		inline int getNumVertices()const { return m_numVertices; }
 		inline int getNumIndices()const { return m_numIndices; }
+		//Whether the index buffer holds GL_UNSIGNED_SHORT instead of GL_UNSIGNED_INT
+		inline bool has16BitIndices()const { return m_16BitIndices; }
+		inline VertexFormat getVertexFormat()const { return m_vertexFormat; }
+		//Maps the uploaded positions back to mesh space. Identity unless the format is QUANTIZED, in which case
+		//positions are drawn with model * getPositionTransform(). Normals are not affected, so keep the model's normal matrix
+		inline const ew::Affine3x4& getPositionTransform()const { return m_positionTransform; }
+		//Mesh space bounds of the last loaded data: MeshData::bounds if it has them, otherwise scanned during load()
+		inline const MeshBounds& getBounds()const { return m_bounds; }
 	private:
+		//Uploads vertices already encoded in vertexFormat, and 16 or 32 bit indices
+		void upload(VertexFormat vertexFormat, const void* vertices, size_t numVertices, const void* indices, size_t numIndices, bool indices16);
+
 		bool m_initialized = false;
 		unsigned int m_vao = 0;
 		unsigned int m_vbo = 0;
 		unsigned int m_ebo = 0;
 		int m_numVertices = 0;
 		int m_numIndices = 0;
+		bool m_16BitIndices = false;
+		VertexFormat m_vertexFormat = VertexFormat::FLOAT;
+		ew::Affine3x4 m_positionTransform = ew::AffineIdentity();
+		MeshBounds m_bounds = {};
 	};
 }
\ No newline at end of file
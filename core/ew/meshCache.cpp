@@ -0,0 +1,105 @@
+#include "meshCache.h"
+#include "procGen.h"
+#include <string.h>
+
+namespace ew {
+	MeshCache::MeshCache(size_t budgetBytes)
+		:m_budget(budgetBytes)
+	{}
+	MeshCache::~MeshCache()
+	{
+		clear();
+	}
+
+	/// <summary>
+	/// FNV-1a over the generator name and the raw bits of the parameters. Parameters are compared bitwise too, so hashing and equality agree (0.0 vs -0.0)
+	/// </summary>
+	size_t MeshCache::KeyHash::operator()(const MeshKey& key)const
+	{
+		size_t hash = 2166136261u;
+		for (const char* c = key.generator; *c; c++) {
+			hash = (hash ^ (unsigned char)*c) * 16777619u;
+		}
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.params);
+		for (size_t i = 0; i < sizeof(key.params); i++) {
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		return (hash ^ (size_t)key.subdivisions) * 16777619u;
+	}
+	bool MeshCache::KeyEqual::operator()(const MeshKey& a, const MeshKey& b)const
+	{
+		return a.subdivisions == b.subdivisions
+			&& memcmp(a.params, b.params, sizeof(a.params)) == 0
+			&& strcmp(a.generator, b.generator) == 0;
+	}
+
+	const Mesh* MeshCache::find(const MeshKey& key)
+	{
+		auto it = m_lookup.find(key);
+		if (it == m_lookup.end()) {
+			m_misses++;
+			return nullptr;
+		}
+		m_hits++;
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return &it->second->mesh;
+	}
+	const Mesh& MeshCache::insert(const MeshKey& key)
+	{
+		size_t bytes = sizeof(Vertex) * m_scratch.vertices.size() + sizeof(unsigned int) * m_scratch.indices.size() + sizeof(unsigned short) * m_scratch.indices16.size();
+		m_entries.push_front(Entry{ key, Mesh(m_scratch), bytes });
+		m_lookup[key] = m_entries.begin();
+		m_memoryUsage += bytes;
+		evict();
+		return m_entries.front().mesh;
+	}
+	const Mesh& MeshCache::getCube(float size)
+	{
+		return get({ "ew::createCube", { size }, 0 }, [&](MeshData* meshData) {
+			createCube(size, meshData);
+		});
+	}
+	const Mesh& MeshCache::getPlane(float width, float height, int subdivisions)
+	{
+		return get({ "ew::createPlane", { width, height }, subdivisions }, [&](MeshData* meshData) {
+			createPlane(width, height, subdivisions, meshData);
+		});
+	}
+	const Mesh& MeshCache::getSphere(float radius, int subdivisions)
+	{
+		return get({ "ew::createSphere", { radius }, subdivisions }, [&](MeshData* meshData) {
+			createSphere(radius, subdivisions, meshData);
+		});
+	}
+	const Mesh& MeshCache::getCylinder(float radius, float height, int subdivisions)
+	{
+		return get({ "ew::createCylinder", { radius, height }, subdivisions }, [&](MeshData* meshData) {
+			createCylinder(radius, height, subdivisions, meshData);
+		});
+	}
+
+	void MeshCache::clear()
+	{
+		for (Entry& entry : m_entries) {
+			entry.mesh.unload();
+		}
+		m_entries.clear();
+		m_lookup.clear();
+		m_memoryUsage = 0;
+	}
+	void MeshCache::setBudget(size_t budgetBytes)
+	{
+		m_budget = budgetBytes;
+		evict();
+	}
+	void MeshCache::evict()
+	{
+		while (m_memoryUsage > m_budget && m_entries.size() > 1) {
+			Entry& oldest = m_entries.back();
+			oldest.mesh.unload();
+			m_memoryUsage -= oldest.bytes;
+			m_lookup.erase(oldest.key);
+			m_entries.pop_back();
+		}
+	}
+}
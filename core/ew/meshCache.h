@@ -0,0 +1,79 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include "mesh.h"
+
+namespace ew {
+	//Identifies a cached mesh: the generator that builds it and the parameters it was given. Unused values should be left at 0.
+	//generator is compared by content, e.g. "lm::createSphere". It is not copied, so use a string literal
+	struct MeshKey {
+		const char* generator;
+		float params[4];
+		int subdivisions;
+	};
+
+	//Keeps meshes built from parameters (shape generators driven by UI, etc.) resident on the GPU.
+	//A mesh is only generated and uploaded the first time its key is asked for. When the vertex/index buffers of all
+	//resident meshes go over the memory budget, the least recently used ones are unloaded.
+	//Needs a current OpenGL context for get() and for destruction
+	class MeshCache {
+	public:
+		//budgetBytes: GPU memory (vertex + index buffers) to keep resident
+		MeshCache(size_t budgetBytes = 64 * 1024 * 1024);
+		~MeshCache();
+		MeshCache(const MeshCache&) = delete;
+		MeshCache& operator=(const MeshCache&) = delete;
+
+		//Returns the mesh for key. generate(MeshData*) is only called on a miss, to fill the (reused) MeshData it is given.
+		//The reference stays valid until a later get() evicts the mesh, so draw it before asking for many others
+		template<typename Generate>
+		const Mesh& get(const MeshKey& key, const Generate& generate) {
+			if (const Mesh* mesh = find(key))
+				return *mesh;
+			generate(&m_scratch);
+			return insert(key);
+		}
+		//ew::procGen shapes
+		const Mesh& getCube(float size);
+		const Mesh& getPlane(float width, float height, int subdivisions);
+		const Mesh& getSphere(float radius, int subdivisions);
+		const Mesh& getCylinder(float radius, float height, int subdivisions);
+
+		//Unloads every mesh
+		void clear();
+		//Evicts right away if the new budget is exceeded
+		void setBudget(size_t budgetBytes);
+		inline size_t getBudget()const { return m_budget; }
+		inline size_t getMemoryUsage()const { return m_memoryUsage; }
+		inline size_t getNumMeshes()const { return m_entries.size(); }
+		//Lookups that found a resident mesh / had to generate one
+		inline size_t getNumHits()const { return m_hits; }
+		inline size_t getNumMisses()const { return m_misses; }
+	private:
+		struct KeyHash {
+			size_t operator()(const MeshKey& key)const;
+		};
+		struct KeyEqual {
+			bool operator()(const MeshKey& a, const MeshKey& b)const;
+		};
+		struct Entry {
+			MeshKey key;
+			Mesh mesh;
+			size_t bytes;
+		};
+		//Resident mesh for key (marked as most recently used), or nullptr
+		const Mesh* find(const MeshKey& key);
+		//Uploads m_scratch as the mesh for key
+		const Mesh& insert(const MeshKey& key);
+		//Unloads least recently used meshes until usage fits the budget, always keeping the most recent one
+		void evict();
+
+		std::list<Entry> m_entries; //Most recently used first
+		std::unordered_map<MeshKey, std::list<Entry>::iterator, KeyHash, KeyEqual> m_lookup;
+		MeshData m_scratch; //Reused by every generate call, so regenerating doesn't allocate once it has grown
+		size_t m_budget;
+		size_t m_memoryUsage = 0;
+		size_t m_hits = 0;
+		size_t m_misses = 0;
+	};
+}
@@ -0,0 +1,210 @@
+#include "meshFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ew {
+	static_assert(sizeof(MeshFileHeader) == 192, "MeshFileHeader must not change size without bumping MESH_FILE_VERSION");
+
+	static uint64_t alignUp(uint64_t offset)
+	{
+		return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+	}
+	/// <summary>
+	/// Writes size bytes and pads with zeros up to the next aligned offset
+	/// </summary>
+	static bool writeAligned(FILE* file, const void* data, size_t size, uint64_t* offset)
+	{
+		static const unsigned char zeros[MESH_FILE_ALIGNMENT] = {};
+		const size_t padding = (size_t)(alignUp(*offset + size) - (*offset + size));
+		if ((size > 0 && fwrite(data, 1, size, file) != size) || (padding > 0 && fwrite(zeros, 1, padding, file) != padding))
+			return false;
+		*offset += size + padding;
+		return true;
+	}
+
+	/// <summary>
+	/// Encodes the vertices and narrows the indices in memory, then writes the header and both blobs in one pass
+	/// </summary>
+	bool writeMeshFile(const char* filePath, const MeshData& meshData, VertexFormat vertexFormat)
+	{
+		const size_t numVertices = meshData.vertices.size();
+		const size_t numIndices = meshData.getNumIndices();
+		for (size_t i = 0; i < numIndices; i++) {
+			if (meshData.getIndex(i) >= numVertices) {
+				printf("Failed to write mesh file %s: index %zu is out of range\n", filePath, i);
+				return false;
+			}
+		}
+
+		MeshFileHeader header = {};
+		memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+		header.version = MESH_FILE_VERSION;
+		header.headerSize = sizeof(MeshFileHeader);
+		header.vertexFormat = (uint32_t)vertexFormat;
+		header.layout = getVertexLayout(vertexFormat);
+		header.bounds = meshData.hasBounds ? meshData.bounds : ComputeBounds(meshData.vertices.data(), numVertices);
+		header.positionTransform = AffineIdentity();
+
+		const void* vertices = meshData.vertices.data();
+		std::vector<PackedVertex> packed;
+		std::vector<QuantizedVertex> quantized;
+		if (vertexFormat == VertexFormat::PACKED) {
+			packed.resize(numVertices);
+			packVertices(meshData.vertices.data(), numVertices, packed.data());
+			vertices = packed.data();
+		}
+		else if (vertexFormat == VertexFormat::QUANTIZED) {
+			quantized.resize(numVertices);
+			header.positionTransform = quantizeVertices(meshData.vertices.data(), numVertices, header.bounds.box, quantized.data());
+			vertices = quantized.data();
+		}
+
+		//16 bit indices whenever the vertex count allows, as Mesh::load uploads them
+		const void* indices = meshData.indices.data();
+		std::vector<unsigned short> indices16;
+		header.indexSize = sizeof(unsigned int);
+		if (meshData.has16BitIndices()) {
+			indices = meshData.indices16.data();
+			header.indexSize = sizeof(unsigned short);
+		}
+		else if (numVertices <= MAX_16BIT_VERTICES) {
+			indices16.assign(meshData.indices.begin(), meshData.indices.end());
+			indices = indices16.data();
+			header.indexSize = sizeof(unsigned short);
+		}
+
+		const size_t vertexBytes = header.layout.stride * numVertices;
+		const size_t indexBytes = header.indexSize * numIndices;
+		header.numVertices = numVertices;
+		header.numIndices = numIndices;
+		header.vertexOffset = alignUp(sizeof(MeshFileHeader));
+		header.indexOffset = alignUp(header.vertexOffset + vertexBytes);
+
+		FILE* file = fopen(filePath, "wb");
+		if (!file) {
+			printf("Failed to write mesh file %s\n", filePath);
+			return false;
+		}
+		uint64_t offset = 0;
+		const bool written = writeAligned(file, &header, sizeof(header), &offset)
+			&& writeAligned(file, vertices, vertexBytes, &offset)
+			&& writeAligned(file, indices, indexBytes, &offset);
+		if (fclose(file) != 0 || !written) {
+			printf("Failed to write mesh file %s\n", filePath);
+			remove(filePath);
+			return false;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Checks everything Mesh::load relies on, without touching the blobs: reading the indices to range check them would
+	/// page in the whole file. writeMeshFile only writes indices that are in range
+	/// </summary>
+	static bool isValidHeader(const MeshFileHeader& header, size_t fileSize)
+	{
+		if (memcmp(header.magic, MESH_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != MESH_FILE_VERSION
+			|| header.headerSize != sizeof(MeshFileHeader) || header.vertexFormat > (uint32_t)VertexFormat::QUANTIZED)
+			return false;
+		const VertexLayout layout = getVertexLayout((VertexFormat)header.vertexFormat);
+		if (memcmp(&header.layout, &layout, sizeof(layout)) != 0)
+			return false;
+		if (header.indexSize != sizeof(unsigned int) && header.indexSize != sizeof(unsigned short))
+			return false;
+		if (header.indexSize == sizeof(unsigned short) && header.numVertices > MAX_16BIT_VERTICES)
+			return false;
+		//Each blob must start aligned after the header and end inside the file. Divisions instead of multiplications, so
+		//huge counts can't overflow
+		auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+			return offset % MESH_FILE_ALIGNMENT == 0 && offset >= sizeof(MeshFileHeader) && offset <= fileSize
+				&& count <= (fileSize - offset) / elementSize && count <= (uint64_t)INT32_MAX;
+		};
+		return fits(header.vertexOffset, header.numVertices, layout.stride) && fits(header.indexOffset, header.numIndices, header.indexSize);
+	}
+
+	MeshFile::~MeshFile()
+	{
+		close();
+	}
+	bool MeshFile::open(const char* filePath)
+	{
+		close();
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file != INVALID_HANDLE_VALUE) {
+			LARGE_INTEGER fileSize;
+			if (GetFileSizeEx(file, &fileSize) && (uint64_t)fileSize.QuadPart >= sizeof(MeshFileHeader) && (uint64_t)fileSize.QuadPart <= SIZE_MAX) {
+				size = (size_t)fileSize.QuadPart;
+				//The view keeps the mapping alive, so neither handle is needed afterwards
+				HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+				if (mapping) {
+					data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+					CloseHandle(mapping);
+				}
+			}
+			CloseHandle(file);
+		}
+#else
+		int file = ::open(filePath, O_RDONLY);
+		if (file >= 0) {
+			struct stat fileStat;
+			if (fstat(file, &fileStat) == 0 && (uint64_t)fileStat.st_size >= sizeof(MeshFileHeader)) {
+				size = (size_t)fileStat.st_size;
+				void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+				if (mapped != MAP_FAILED) {
+					data = (const unsigned char*)mapped;
+					//Start reading ahead now, since the whole file is about to be copied to the GPU
+					madvise(mapped, size, MADV_WILLNEED);
+				}
+			}
+			::close(file);
+		}
+#endif
+		if (!data) {
+			printf("Failed to load mesh file %s\n", filePath);
+			return false;
+		}
+		m_data = data;
+		m_size = size;
+		if (!isValidHeader(getHeader(), m_size)) {
+			printf("Failed to load mesh file %s: not a version %u mesh file, or truncated\n", filePath, MESH_FILE_VERSION);
+			close();
+			return false;
+		}
+		return true;
+	}
+	void MeshFile::close()
+	{
+		if (!m_data)
+			return;
+#if defined(_WIN32)
+		UnmapViewOfFile(m_data);
+#else
+		munmap((void*)m_data, m_size);
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	bool loadMeshFile(const char* filePath, Mesh* mesh)
+	{
+		MeshFile file;
+		if (!file.open(filePath))
+			return false;
+		mesh->load(file);
+		return true;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include "mesh.h"
+#include "vertexFormat.h"
+
+namespace ew {
+	//Binary mesh file (.ewm), made to be memory mapped and uploaded without parsing:
+	//	MeshFileHeader
+	//	vertices, already encoded in the header's vertex format, at vertexOffset
+	//	indices (16 bit if the vertices allow it, otherwise 32 bit), at indexOffset
+	//Both blobs start on a multiple of MESH_FILE_ALIGNMENT. Values are stored little endian, as in memory on every platform we build for
+	constexpr char MESH_FILE_MAGIC[4] = { 'E', 'W', 'M', 'F' };
+	//Bumped whenever the layout changes. Files of other versions are rejected
+	constexpr uint32_t MESH_FILE_VERSION = 1;
+	constexpr uint64_t MESH_FILE_ALIGNMENT = 64;
+
+	struct MeshFileHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t headerSize; //sizeof(MeshFileHeader) when written
+		uint32_t vertexFormat; //ew::VertexFormat
+		VertexLayout layout; //getVertexLayout(vertexFormat) of the writer, checked against the reader's
+		uint32_t indexSize; //2 or 4 bytes
+		uint64_t numVertices;
+		uint64_t numIndices;
+		uint64_t vertexOffset; //From the start of the file
+		uint64_t indexOffset;
+		MeshBounds bounds; //Mesh space, as MeshData::bounds
+		Affine3x4 positionTransform; //Identity unless the format is QUANTIZED. See Mesh::getPositionTransform()
+	};
+
+	//Encodes meshData in vertexFormat and writes it to filePath. Bounds are meshData's if it has them, otherwise scanned.
+	//Returns false if an index is out of range or the file can't be written
+	bool writeMeshFile(const char* filePath, const MeshData& meshData, VertexFormat vertexFormat = VertexFormat::FLOAT);
+
+	//A mesh file mapped into memory (mmap, or a file mapping on Windows). Nothing is read until the data is touched,
+	//so Mesh::load(file) pages the blobs in as glBufferData copies them and startup is bound by I/O, not by generating meshes
+	class MeshFile {
+	public:
+		MeshFile() {};
+		~MeshFile();
+		MeshFile(const MeshFile&) = delete;
+		MeshFile& operator=(const MeshFile&) = delete;
+
+		//Maps filePath and checks its header. Returns false (and stays closed) if it can't be opened, isn't a mesh file of
+		//MESH_FILE_VERSION, or its blobs don't fit in the file
+		bool open(const char* filePath);
+		//Unmaps the file. Pointers from getVertices()/getIndices() are invalid afterwards
+		void close();
+		inline bool isOpen()const { return m_data != nullptr; }
+
+		//Only valid while open
+		inline const MeshFileHeader& getHeader()const { return *(const MeshFileHeader*)m_data; }
+		inline VertexFormat getVertexFormat()const { return (VertexFormat)getHeader().vertexFormat; }
+		inline const void* getVertices()const { return m_data + getHeader().vertexOffset; }
+		inline const void* getIndices()const { return m_data + getHeader().indexOffset; }
+		//The whole file, getSize() bytes
+		inline const void* getData()const { return m_data; }
+		inline size_t getSize()const { return m_size; }
+	private:
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+	};
+
+	//Opens filePath, uploads it into mesh and closes it again. Returns false if the file couldn't be opened
+	bool loadMeshFile(const char* filePath, Mesh* mesh);
+}
@@ -0,0 +1,48 @@
+#include "meshLOD.h"
+#include <algorithm>
+
+namespace ew {
+	float GetPixelsPerUnit(const Camera& camera, float distance, float screenHeight)
+	{
+		if (camera.orthographic)
+			return screenHeight / camera.orthoHeight;
+		const float MIN_DISTANCE = 1e-4f;
+		return screenHeight / (2.0f * std::max(distance, MIN_DISTANCE) * tanf(ew::Radians(camera.fov) * 0.5f));
+	}
+
+	void MeshLOD::addLevel(const MeshData& meshData, float error, VertexFormat vertexFormat)
+	{
+		m_levels.push_back(Level{ Mesh(meshData, vertexFormat), error });
+	}
+	void MeshLOD::unload()
+	{
+		for (Level& level : m_levels) {
+			level.mesh.unload();
+		}
+		m_levels.clear();
+	}
+
+	/// <summary>
+	/// Walks from the finest level towards coarser ones while their projected error stays within the limit.
+	/// Levels coarser than previousLevel must also clear the hysteresis margin, so a level is only given up for
+	/// a coarser one when the coarser one is comfortably good enough
+	/// </summary>
+	int MeshLOD::selectLevel(const Camera& camera, float distance, float screenHeight, int previousLevel, float scale) const
+	{
+		const float pixelsPerError = GetPixelsPerUnit(camera, distance, screenHeight) * scale;
+		int level = 0;
+		for (int i = 1; i < (int)m_levels.size(); i++) {
+			float limit = maxPixelError;
+			if (previousLevel >= 0 && i > previousLevel)
+				limit *= 1.0f - hysteresis;
+			if (m_levels[i].error * pixelsPerError > limit)
+				break;
+			level = i;
+		}
+		return level;
+	}
+	void MeshLOD::draw(int level, DrawMode drawMode) const
+	{
+		m_levels[level].mesh.draw(drawMode);
+	}
+}
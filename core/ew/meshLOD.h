@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "camera.h"
+
+namespace ew {
+	//Screen pixels covered by one world unit at distance from camera, vertically. Orthographic cameras ignore distance
+	float GetPixelsPerUnit(const Camera& camera, float distance, float screenHeight);
+
+	//Several versions of one mesh, from most to least detailed, each with its geometric error: how far its surface
+	//strays from the most detailed shape, in mesh units (see getSphereError for generated spheres).
+	//selectLevel() picks the coarsest level whose error covers at most maxPixelError pixels on screen.
+	//Like Mesh, levels are GPU buffers that must be freed with unload()
+	class MeshLOD {
+	public:
+		//Largest allowed on screen error, in pixels
+		float maxPixelError = 1.0f;
+		//A coarser level is only switched to once its error is this fraction below maxPixelError, so an object
+		//sitting right at a switching distance doesn't pop back and forth. Switching to finer levels is immediate
+		float hysteresis = 0.25f;
+
+		//Levels must be added from most to least detailed, with non decreasing error
+		void addLevel(const MeshData& meshData, float error, VertexFormat vertexFormat = VertexFormat::FLOAT);
+		void unload();
+
+		//Level to draw for an object at distance from camera. scale: largest axis scale of the object's model matrix.
+		//previousLevel: level this object was drawn with last frame, for hysteresis (-1 for none). Keep it per object,
+		//since one MeshLOD is usually shared by many objects
+		int selectLevel(const Camera& camera, float distance, float screenHeight, int previousLevel = -1, float scale = 1.0f)const;
+		//QUANTIZED levels each have their own position transform, see getMesh(level).getPositionTransform()
+		void draw(int level, DrawMode drawMode = DrawMode::TRIANGLES)const;
+
+		inline int getNumLevels()const { return (int)m_levels.size(); }
+		inline const Mesh& getMesh(int level)const { return m_levels[level].mesh; }
+		inline float getError(int level)const { return m_levels[level].error; }
+	private:
+		struct Level {
+			Mesh mesh;
+			float error;
+		};
+		std::vector<Level> m_levels;
+	};
+}
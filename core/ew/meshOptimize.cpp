@@ -0,0 +1,318 @@
+#include "meshOptimize.h"
+#include "jobs.h"
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+namespace ew {
+	//Cache simulation: a vertex is cached if it was one of the last cacheSize vertices loaded.
+	//time counts loads and starts past cacheSize, so every vertex misses the first time
+	static inline bool isCached(unsigned int time, unsigned int cacheTime, int cacheSize) {
+		return time - cacheTime <= (unsigned int)cacheSize;
+	}
+
+	//Number of vertices the indices refer to (largest index + 1)
+	template<typename Index>
+	static size_t getNumReferenced(const Index* indices, size_t numIndices)
+	{
+		size_t numReferenced = 0;
+		for (size_t i = 0; i < numIndices; i++) {
+			if (indices[i] >= numReferenced)
+				numReferenced = (size_t)indices[i] + 1;
+		}
+		return numReferenced;
+	}
+
+	template<typename Index>
+	static VertexCacheStats analyzeVertexCache(const Index* indices, size_t numIndices, size_t numVertices, int cacheSize)
+	{
+		VertexCacheStats stats;
+		if (numIndices < 3)
+			return stats;
+		std::vector<unsigned int> cacheTime(std::max(numVertices, getNumReferenced(indices, numIndices)), 0);
+		unsigned int time = cacheSize + 1;
+		size_t numUsed = 0;
+		for (size_t i = 0; i < numIndices; i++) {
+			Index v = indices[i];
+			if (cacheTime[v] == 0)
+				numUsed++;
+			if (!isCached(time, cacheTime[v], cacheSize))
+				cacheTime[v] = time++;
+		}
+		size_t misses = time - (cacheSize + 1);
+		stats.acmr = (float)misses / (numIndices / 3);
+		stats.atvr = (float)misses / numUsed;
+		return stats;
+	}
+
+	/// <summary>
+	/// Tipsify: fans around one vertex at a time, emitting all of its remaining triangles. The next vertex to fan around
+	/// is the one touched by those triangles that will stay in the cache the longest, so its triangles reuse cached vertices.
+	/// When none qualifies, it backtracks through recently used vertices, then scans in order. Linear in the number of indices
+	/// </summary>
+	template<typename Index>
+	static void tipsify(Index* indices, size_t numIndices, size_t numVertices, int cacheSize)
+	{
+		const size_t NONE = (size_t)-1;
+		const size_t numTriangles = numIndices / 3;
+
+		//Triangles using each vertex, as one array with per vertex offsets
+		std::vector<unsigned int> liveTriangles(numVertices, 0);
+		for (size_t i = 0; i < numTriangles * 3; i++) {
+			liveTriangles[indices[i]]++;
+		}
+		std::vector<unsigned int> offsets(numVertices + 1, 0);
+		for (size_t v = 0; v < numVertices; v++) {
+			offsets[v + 1] = offsets[v] + liveTriangles[v];
+		}
+		std::vector<unsigned int> adjacency(numTriangles * 3);
+		std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < numTriangles * 3; i++) {
+			adjacency[fill[indices[i]]++] = i / 3;
+		}
+
+		std::vector<unsigned int> cacheTime(numVertices, 0);
+		std::vector<bool> emitted(numTriangles, false);
+		std::vector<unsigned int> deadEnd;
+		std::vector<unsigned int> candidates;
+		std::vector<Index> sorted;
+		deadEnd.reserve(numTriangles * 3);
+		sorted.reserve(numTriangles * 3);
+		unsigned int time = cacheSize + 1;
+		size_t cursor = 0;
+
+		//Most recently used vertex that still has triangles left, or the next one in order
+		auto skipDeadEnd = [&]() {
+			while (!deadEnd.empty()) {
+				unsigned int v = deadEnd.back();
+				deadEnd.pop_back();
+				if (liveTriangles[v] > 0)
+					return (size_t)v;
+			}
+			while (cursor < numVertices) {
+				if (liveTriangles[cursor] > 0)
+					return cursor;
+				cursor++;
+			}
+			return NONE;
+		};
+
+		size_t fanning = skipDeadEnd();
+		while (fanning != NONE) {
+			candidates.clear();
+			for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+				unsigned int t = adjacency[a];
+				if (emitted[t])
+					continue;
+				emitted[t] = true;
+				for (int k = 0; k < 3; k++) {
+					Index v = indices[t * 3 + k];
+					sorted.push_back(v);
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					liveTriangles[v]--;
+					if (!isCached(time, cacheTime[v], cacheSize))
+						cacheTime[v] = time++;
+				}
+			}
+			//Oldest candidate that will still be cached after fanning its remaining triangles (at most 2 new vertices each)
+			size_t next = NONE;
+			int bestPriority = -1;
+			for (unsigned int v : candidates) {
+				if (liveTriangles[v] == 0)
+					continue;
+				int priority = 0;
+				if (time - cacheTime[v] + 2 * liveTriangles[v] <= (unsigned int)cacheSize)
+					priority = time - cacheTime[v];
+				if (priority > bestPriority) {
+					bestPriority = priority;
+					next = v;
+				}
+			}
+			fanning = next != NONE ? next : skipDeadEnd();
+		}
+		std::copy(sorted.begin(), sorted.end(), indices);
+	}
+
+	//Tipsify can lose to the original order on small, already cache friendly meshes, so keep whichever is better
+	template<typename Index>
+	static VertexCacheStats tipsifyIfBetter(std::vector<Index>& indices, size_t numVertices, int cacheSize, const VertexCacheStats& before)
+	{
+		std::vector<Index> original = indices;
+		tipsify(indices.data(), indices.size(), numVertices, cacheSize);
+		VertexCacheStats after = analyzeVertexCache(indices.data(), indices.size(), numVertices, cacheSize);
+		if (after.acmr > before.acmr) {
+			indices.swap(original);
+			return before;
+		}
+		return after;
+	}
+
+	template<typename Index>
+	static void remapVertices(Index* indices, size_t numIndices, std::vector<Vertex>& vertices)
+	{
+		const unsigned int UNUSED = (unsigned int)-1;
+		std::vector<unsigned int> remap(vertices.size(), UNUSED);
+		unsigned int next = 0;
+		for (size_t i = 0; i < numIndices; i++) {
+			if (remap[indices[i]] == UNUSED)
+				remap[indices[i]] = next++;
+			indices[i] = remap[indices[i]];
+		}
+		for (size_t v = 0; v < vertices.size(); v++) {
+			if (remap[v] == UNUSED)
+				remap[v] = next++;
+		}
+		std::vector<Vertex> reordered(vertices.size());
+		for (size_t v = 0; v < vertices.size(); v++) {
+			reordered[remap[v]] = vertices[v];
+		}
+		vertices.swap(reordered);
+	}
+
+	VertexCacheStats analyzeVertexCache(const MeshData& meshData, int cacheSize)
+	{
+		if (meshData.has16BitIndices())
+			return analyzeVertexCache(meshData.indices16.data(), meshData.indices16.size(), meshData.vertices.size(), cacheSize);
+		return analyzeVertexCache(meshData.indices.data(), meshData.indices.size(), meshData.vertices.size(), cacheSize);
+	}
+	/// <summary>
+	/// Optimizing reads vertices through the indices, so a mesh with out of range indices is left as it is
+	/// </summary>
+	static bool hasValidIndices(const MeshData& meshData)
+	{
+		if (meshData.has16BitIndices())
+			return getNumReferenced(meshData.indices16.data(), meshData.indices16.size()) <= meshData.vertices.size();
+		return getNumReferenced(meshData.indices.data(), meshData.indices.size()) <= meshData.vertices.size();
+	}
+
+	VertexCacheReport optimizeVertexCache(MeshData* meshData, int cacheSize)
+	{
+		VertexCacheReport report;
+		report.before = analyzeVertexCache(*meshData, cacheSize);
+		report.after = report.before;
+		if (!hasValidIndices(*meshData))
+			return report;
+		if (meshData->has16BitIndices())
+			report.after = tipsifyIfBetter(meshData->indices16, meshData->vertices.size(), cacheSize, report.before);
+		else
+			report.after = tipsifyIfBetter(meshData->indices, meshData->vertices.size(), cacheSize, report.before);
+		return report;
+	}
+	void optimizeVertexFetch(MeshData* meshData)
+	{
+		if (!hasValidIndices(*meshData))
+			return;
+		if (meshData->has16BitIndices())
+			remapVertices(meshData->indices16.data(), meshData->indices16.size(), meshData->vertices);
+		else
+			remapVertices(meshData->indices.data(), meshData->indices.size(), meshData->vertices);
+	}
+
+	//Vertex attributes as compared by weldVertices: raw float bits, or multiples of epsilon
+	struct WeldKey {
+		int64_t values[8];
+	};
+	static inline int64_t getWeldValue(float value, float invEpsilon) {
+		if (invEpsilon > 0.0f)
+			return (int64_t)floor((double)value * invEpsilon + 0.5);
+		value += 0.0f; //-0 and 0 have different bits
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+	//Vertex indices stored in the weld hash sets, hashed and compared through their keys
+	struct WeldHash {
+		const size_t* hashes;
+		size_t operator()(unsigned int v)const { return hashes[v]; }
+	};
+	struct WeldEqual {
+		const WeldKey* keys;
+		int numValues;
+		bool operator()(unsigned int a, unsigned int b)const {
+			return memcmp(keys[a].values, keys[b].values, sizeof(int64_t) * numValues) == 0;
+		}
+	};
+
+	template<typename Index>
+	static void remapIndices(Index* indices, size_t numIndices, const unsigned int* remap, int maxThreads)
+	{
+		auto remapRange = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				indices[i] = remap[indices[i]];
+			}
+		};
+		parallelFor(numIndices, 1 << 16, std::cref(remapRange), maxThreads);
+	}
+
+	/// <summary>
+	/// Vertices are split into one part per thread by hash. Equal vertices always hash to the same part, so each part
+	/// is welded by its own thread with its own hash set. Every vertex maps to the lowest indexed vertex equal to it,
+	/// which keeps the result independent of the thread count. Compaction and remapping then keep vertices in their original order
+	/// </summary>
+	size_t weldVertices(MeshData* meshData, float epsilon, WeldMode mode, int maxThreads)
+	{
+		std::vector<Vertex>& vertices = meshData->vertices;
+		const size_t numVertices = vertices.size();
+		if (numVertices < 2 || !hasValidIndices(*meshData))
+			return 0;
+		const float invEpsilon = epsilon > 0.0f ? 1.0f / epsilon : 0.0f;
+		const int numValues = mode == WeldMode::ALL_ATTRIBUTES ? 8 : 6;
+		const size_t minChunk = 16384;
+
+		std::vector<WeldKey> keys(numVertices);
+		std::vector<size_t> hashes(numVertices);
+		auto computeKeys = [&](size_t begin, size_t end) {
+			for (size_t v = begin; v < end; v++) {
+				const Vertex& vertex = vertices[v];
+				const float values[8] = { vertex.pos.x, vertex.pos.y, vertex.pos.z, vertex.normal.x, vertex.normal.y, vertex.normal.z, vertex.uv.x, vertex.uv.y };
+				size_t hash = 2166136261u;
+				for (int i = 0; i < numValues; i++) {
+					keys[v].values[i] = getWeldValue(values[i], invEpsilon);
+					hash = (hash ^ (size_t)keys[v].values[i]) * 16777619u;
+				}
+				hashes[v] = hash ^ (hash >> 15);
+			}
+		};
+		parallelFor(numVertices, minChunk, std::cref(computeKeys), maxThreads);
+
+		std::vector<unsigned int> representative(numVertices);
+		size_t numParts = numVertices >= minChunk * 2 ? (size_t)getNumJobThreads() : 1;
+		if (maxThreads > 0 && numParts > (size_t)maxThreads)
+			numParts = maxThreads;
+		auto weldParts = [&](size_t begin, size_t end) {
+			for (size_t part = begin; part < end; part++) {
+				std::unordered_set<unsigned int, WeldHash, WeldEqual> unique(numVertices / numParts + 1, WeldHash{ hashes.data() }, WeldEqual{ keys.data(), numValues });
+				for (size_t v = 0; v < numVertices; v++) {
+					if (hashes[v] % numParts == part)
+						representative[v] = *unique.insert((unsigned int)v).first;
+				}
+			}
+		};
+		parallelFor(numParts, 1, std::cref(weldParts), maxThreads);
+
+		//Representatives come before the vertices merged into them, so compacting in place only moves vertices down
+		std::vector<unsigned int> remap(numVertices);
+		size_t numUnique = 0;
+		for (size_t v = 0; v < numVertices; v++) {
+			if (representative[v] == v) {
+				remap[v] = numUnique;
+				vertices[numUnique++] = vertices[v];
+			}
+			else {
+				remap[v] = remap[representative[v]];
+			}
+		}
+		if (numUnique == numVertices)
+			return 0;
+		vertices.resize(numUnique);
+		if (meshData->has16BitIndices())
+			remapIndices(meshData->indices16.data(), meshData->indices16.size(), remap.data(), maxThreads);
+		else
+			remapIndices(meshData->indices.data(), meshData->indices.size(), remap.data(), maxThreads);
+		return numVertices - numUnique;
+	}
+}
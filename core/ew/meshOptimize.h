@@ -0,0 +1,36 @@
+#pragma once
+#include "mesh.h"
+
+namespace ew {
+	//How well an index order uses the GPU's post-transform vertex cache, simulated as a FIFO of cacheSize vertices
+	struct VertexCacheStats {
+		float acmr = 0.0f; //Average cache miss ratio: vertex shader runs per triangle. 3 is the worst, regular grids can get close to 0.5
+		float atvr = 0.0f; //Average transformed vertex ratio: vertex shader runs per vertex used. 1 is the best possible
+	};
+	struct VertexCacheReport {
+		VertexCacheStats before;
+		VertexCacheStats after;
+	};
+
+	VertexCacheStats analyzeVertexCache(const MeshData& meshData, int cacheSize = 16);
+
+	//These work on generated and loaded meshes alike, with either index width.
+	//Meshes with indices past the end of vertices are left unchanged by all passes below.
+	//Reorders triangles so vertices get reused while they are still in the post-transform cache (Tipsify, Sander et al. 2007).
+	//Only the order of the triangles changes; each keeps its vertices and winding
+	VertexCacheReport optimizeVertexCache(MeshData* meshData, int cacheSize = 16);
+	//Reorders vertices into the order the indices first use them and remaps the indices, so vertex fetches walk memory forward.
+	//Run after optimizeVertexCache. Vertices no triangle uses are kept, at the end
+	void optimizeVertexFetch(MeshData* meshData);
+
+	//Attributes that must match for weldVertices to merge two vertices
+	enum class WeldMode {
+		ALL_ATTRIBUTES = 0, //Position, normal and UV, so texture seams stay split
+		POSITION_NORMAL = 1 //Ignores UVs (untextured or depth only meshes). Merged vertices keep the first one's UV
+	};
+	//Merges vertices whose attributes are equal, and remaps the indices to the first of each group.
+	//epsilon > 0 snaps attributes to multiples of epsilon before comparing, so vertices that differ by float error are merged too.
+	//Vertices are hashed in parallel for large meshes (maxThreads as in procGen). The index width is kept; call
+	//compactIndices() afterwards to switch to 16 bit indices if the mesh now fits. Returns the number of vertices removed
+	size_t weldVertices(MeshData* meshData, float epsilon = 0.0f, WeldMode mode = WeldMode::ALL_ATTRIBUTES, int maxThreads = 0);
+}
@@ -0,0 +1,240 @@
+#include "meshlets.h"
+#include <algorithm>
+#include <float.h>
+
+namespace ew {
+	static bool hasValidIndices(const MeshData& meshData)
+	{
+		for (size_t i = 0; i < meshData.getNumIndices(); i++) {
+			if (meshData.getIndex(i) >= meshData.vertices.size())
+				return false;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Sphere around the center of the vertices' box, and the cone around the average triangle normal.
+	/// Degenerate triangles have no normal and are left out of the cone
+	/// </summary>
+	static void computeBounds(Meshlet* meshlet, const std::vector<Vertex>& vertices, const unsigned int* indices, const std::vector<Vec3>& normals, size_t firstTriangle)
+	{
+		const size_t numTriangles = meshlet->numIndices / 3;
+		Vec3 min = vertices[indices[0]].pos, max = min;
+		Vec3 normalSum = Vec3(0.0f);
+		for (size_t i = 0; i < meshlet->numIndices; i++) {
+			const Vec3& p = vertices[indices[i]].pos;
+			min = Vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+			max = Vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+		}
+		for (size_t t = 0; t < numTriangles; t++) {
+			normalSum += normals[firstTriangle + t];
+		}
+		const Vec3 center = (min + max) * 0.5f;
+		float radius = 0.0f;
+		for (size_t i = 0; i < meshlet->numIndices; i++) {
+			radius = std::max(radius, Magnitude(vertices[indices[i]].pos - center));
+		}
+		meshlet->bounds = BoundingSphere{ center, radius };
+
+		meshlet->coneAxis = Vec3(0.0f);
+		meshlet->coneCutoff = 1.0f;
+		const float length = Magnitude(normalSum);
+		if (length == 0.0f)
+			return;
+		const Vec3 axis = normalSum / length;
+		float minDot = 1.0f;
+		for (size_t t = 0; t < numTriangles; t++) {
+			const Vec3& n = normals[firstTriangle + t];
+			if (n.x != 0.0f || n.y != 0.0f || n.z != 0.0f)
+				minDot = std::min(minDot, Dot(n, axis));
+		}
+		meshlet->coneAxis = axis;
+		if (minDot > 0.0f)
+			meshlet->coneCutoff = sqrtf(1.0f - minDot * minDot);
+	}
+
+	/// <summary>
+	/// Greedy clustering. Triangles next to the current meshlet are kept in a candidate list; each step adds the candidate
+	/// that needs the fewest new vertices, breaking ties by distance to the meshlet's center weighted by how far its normal
+	/// turns from the meshlet's. A meshlet closes when it is full or has no neighbors left, and the next one starts from a
+	/// triangle it left behind, so consecutive meshlets stay next to each other
+	/// </summary>
+	MeshletData buildMeshlets(const MeshData& meshData, size_t maxVertices, size_t maxTriangles)
+	{
+		MeshletData result;
+		result.meshData.vertices = meshData.vertices;
+		result.meshData.bounds = meshData.bounds;
+		result.meshData.hasBounds = meshData.hasBounds;
+		const size_t numVertices = meshData.vertices.size();
+		const size_t numTriangles = meshData.getNumIndices() / 3;
+		if (!hasValidIndices(meshData) || numTriangles == 0) {
+			result.meshData = meshData;
+			return result;
+		}
+		maxVertices = std::max(maxVertices, (size_t)3);
+		maxTriangles = std::max(maxTriangles, (size_t)1);
+
+		std::vector<unsigned int> indices(numTriangles * 3);
+		for (size_t i = 0; i < indices.size(); i++) {
+			indices[i] = meshData.getIndex(i);
+		}
+		const std::vector<Vertex>& vertices = meshData.vertices;
+		std::vector<Vec3> centroids(numTriangles);
+		std::vector<Vec3> normals(numTriangles);
+		for (size_t t = 0; t < numTriangles; t++) {
+			const Vec3& a = vertices[indices[t * 3]].pos;
+			const Vec3& b = vertices[indices[t * 3 + 1]].pos;
+			const Vec3& c = vertices[indices[t * 3 + 2]].pos;
+			centroids[t] = (a + b + c) / 3.0f;
+			const Vec3 normal = Cross(b - a, c - a);
+			const float length = Magnitude(normal);
+			normals[t] = length > 0.0f ? normal / length : Vec3(0.0f);
+		}
+
+		//Triangles using each vertex
+		std::vector<unsigned int> triangleOffsets(numVertices + 1, 0);
+		std::vector<unsigned int> vertexTriangles(indices.size());
+		for (unsigned int index : indices) {
+			triangleOffsets[index + 1]++;
+		}
+		for (size_t v = 0; v < numVertices; v++) {
+			triangleOffsets[v + 1] += triangleOffsets[v];
+		}
+		{
+			std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++) {
+				vertexTriangles[fill[indices[i]]++] = (unsigned int)(i / 3);
+			}
+		}
+
+		std::vector<unsigned int>& indicesOut = result.meshData.indices;
+		indicesOut.reserve(indices.size());
+		std::vector<Vec3> meshletNormals(numTriangles); //In the order of indicesOut
+		std::vector<bool> used(numTriangles, false);
+		//Stamps (meshlet number + 1) instead of flags, so nothing needs clearing between meshlets
+		std::vector<unsigned int> vertexInMeshlet(numVertices, 0);
+		std::vector<unsigned int> triangleQueued(numTriangles, 0);
+		std::vector<unsigned int> candidates;
+		size_t nextSeed = 0;
+		size_t numEmitted = 0;
+		while (numEmitted < numTriangles) {
+			const unsigned int stamp = (unsigned int)result.meshlets.size() + 1;
+			//Start next to the previous meshlet if it left a neighbor unused
+			size_t seed = numTriangles;
+			for (unsigned int t : candidates) {
+				if (!used[t]) {
+					seed = t;
+					break;
+				}
+			}
+			if (seed == numTriangles) {
+				while (used[nextSeed]) {
+					nextSeed++;
+				}
+				seed = nextSeed;
+			}
+			candidates.clear();
+
+			Meshlet meshlet = {};
+			meshlet.firstIndex = (unsigned int)indicesOut.size();
+			const size_t firstTriangle = numEmitted;
+			Vec3 centroidSum = Vec3(0.0f);
+			Vec3 normalSum = Vec3(0.0f);
+			size_t triangle = seed;
+			while (true) {
+				//Add the triangle and queue its unused neighbors
+				used[triangle] = true;
+				for (int k = 0; k < 3; k++) {
+					unsigned int v = indices[triangle * 3 + k];
+					indicesOut.push_back(v);
+					if (vertexInMeshlet[v] != stamp) {
+						vertexInMeshlet[v] = stamp;
+						meshlet.numVertices++;
+					}
+					for (unsigned int i = triangleOffsets[v]; i < triangleOffsets[v + 1]; i++) {
+						unsigned int neighbor = vertexTriangles[i];
+						if (!used[neighbor] && triangleQueued[neighbor] != stamp) {
+							triangleQueued[neighbor] = stamp;
+							candidates.push_back(neighbor);
+						}
+					}
+				}
+				meshletNormals[numEmitted++] = normals[triangle];
+				meshlet.numIndices += 3;
+				centroidSum += centroids[triangle];
+				normalSum += normals[triangle];
+				if (meshlet.numIndices / 3 >= maxTriangles)
+					break;
+
+				const Vec3 center = centroidSum / (float)(meshlet.numIndices / 3);
+				const float normalLength = Magnitude(normalSum);
+				const Vec3 axis = normalLength > 0.0f ? normalSum / normalLength : Vec3(0.0f);
+				size_t best = numTriangles;
+				int bestExtra = 4;
+				float bestCost = FLT_MAX;
+				size_t kept = 0;
+				for (size_t i = 0; i < candidates.size(); i++) {
+					const unsigned int t = candidates[i];
+					if (used[t])
+						continue;
+					candidates[kept++] = t;
+					int extra = 0;
+					for (int k = 0; k < 3; k++) {
+						extra += vertexInMeshlet[indices[t * 3 + k]] != stamp;
+					}
+					if (meshlet.numVertices + extra > maxVertices || extra > bestExtra)
+						continue;
+					const float cost = Magnitude(centroids[t] - center) * (2.0f - Dot(normals[t], axis));
+					if (extra < bestExtra || cost < bestCost) {
+						best = t;
+						bestExtra = extra;
+						bestCost = cost;
+					}
+				}
+				candidates.resize(kept);
+				if (best == numTriangles)
+					break;
+				triangle = best;
+			}
+			computeBounds(&meshlet, vertices, &indicesOut[meshlet.firstIndex], meshletNormals, firstTriangle);
+			result.meshlets.push_back(meshlet);
+		}
+		if (meshData.has16BitIndices())
+			result.meshData.compactIndices();
+		return result;
+	}
+
+	/// <summary>
+	/// The meshlet is backfacing if the direction to its center is inside the cone of directions that see every triangle from
+	/// behind. The radius term widens that for the other points of the bounding sphere
+	/// </summary>
+	bool IsMeshletBackfacing(const Meshlet& meshlet, const ew::Vec3& cameraPosition)
+	{
+		const Vec3 toCenter = meshlet.bounds.center - cameraPosition;
+		return Dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * Magnitude(toCenter) + meshlet.bounds.radius;
+	}
+
+	size_t cullMeshlets(const std::vector<Meshlet>& meshlets, const Frustum& frustum, const ew::Vec3& cameraPosition, unsigned int* visibleOut)
+	{
+		size_t numVisible = 0;
+		for (size_t i = 0; i < meshlets.size(); i++) {
+			const Meshlet& meshlet = meshlets[i];
+			if (frustum.intersects(meshlet.bounds) && !IsMeshletBackfacing(meshlet, cameraPosition))
+				visibleOut[numVisible++] = (unsigned int)i;
+		}
+		return numVisible;
+	}
+
+	void drawMeshlets(const Mesh& mesh, const std::vector<Meshlet>& meshlets, const unsigned int* visible, size_t numVisible)
+	{
+		size_t i = 0;
+		while (i < numVisible) {
+			const Meshlet& first = meshlets[visible[i]];
+			unsigned int end = first.firstIndex + first.numIndices;
+			for (i++; i < numVisible && meshlets[visible[i]].firstIndex == end; i++) {
+				end += meshlets[visible[i]].numIndices;
+			}
+			mesh.drawRange(first.firstIndex, end - first.firstIndex);
+		}
+	}
+}
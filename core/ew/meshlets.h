@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "frustum.h"
+
+namespace ew {
+	//A cluster of neighboring triangles, stored as one contiguous range of the index buffer
+	struct Meshlet {
+		unsigned int firstIndex;
+		unsigned int numIndices;
+		unsigned int numVertices; //Distinct vertices its triangles use
+		BoundingSphere bounds; //Mesh space
+		//Every triangle normal lies within the cone around coneAxis. coneCutoff is the sine of the cone's half angle,
+		//or 1 when the normals spread too far for the cone to reject anything
+		ew::Vec3 coneAxis;
+		float coneCutoff;
+	};
+
+	struct MeshletData {
+		MeshData meshData; //The input with its triangles reordered so each meshlet is a contiguous index range. Vertices are unchanged
+		std::vector<Meshlet> meshlets;
+	};
+
+	//Splits a mesh into meshlets of at most maxVertices vertices and maxTriangles triangles, by growing each one from a seed
+	//triangle with the neighbors that add the fewest new vertices and stay closest to its center.
+	//Triangle winding is kept, and vertices can be reordered afterwards (optimizeVertexFetch) without changing the ranges.
+	//Meshes with indices past the end of vertices are copied with no meshlets
+	MeshletData buildMeshlets(const MeshData& meshData, size_t maxVertices = 64, size_t maxTriangles = 124);
+
+	//Whether every triangle of the meshlet faces away from cameraPosition (in mesh space), for counterclockwise front faces
+	bool IsMeshletBackfacing(const Meshlet& meshlet, const ew::Vec3& cameraPosition);
+	//Writes the indices of the meshlets that are inside the frustum and not backfacing to visibleOut, in increasing order, and returns
+	//how many there are. frustum and cameraPosition must be in mesh space: build the frustum from projection * view * model and
+	//move the camera position by the inverse model matrix. visibleOut must have room for meshlets.size() indices
+	size_t cullMeshlets(const std::vector<Meshlet>& meshlets, const Frustum& frustum, const ew::Vec3& cameraPosition, unsigned int* visibleOut);
+	//Draws the listed meshlets of a mesh loaded from MeshletData::meshData, merging neighboring ranges into one draw call
+	void drawMeshlets(const Mesh& mesh, const std::vector<Meshlet>& meshlets, const unsigned int* visible, size_t numVisible);
+}
@@ -4,17 +4,92 @@
 
 
 #include "procGen.h"
+#include "jobs.h"
 #include <stdlib.h>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
 
 namespace ew {
+	/// <summary>
+	/// Grid rows per job for parallelFor, so each job gets enough vertices to be worth handing to a worker.
+	/// Small meshes end up as a single job and are built on the calling thread.
+	/// Jobs are passed as std::cref(lambda), which std::function stores without allocating
+	/// </summary>
+	/// <param name="columns">Vertices per row</param>
+	static size_t rowsPerJob(size_t columns) {
+		const size_t MIN_VERTICES_PER_JOB = 16384;
+		return std::max<size_t>(MIN_VERTICES_PER_JOB / std::max<size_t>(columns, 1), 1);
+	}
+	/// <summary>
+	/// Sine and cosine of angle
+	/// </summary>
+	/// <param name="fastTrig">Use ew::FastSinCos instead of sinf/cosf</param>
+	static void sinCos(float angle, bool fastTrig, float* sinOut, float* cosOut) {
+		if (fastTrig) {
+			ew::FastSinCos(angle, sinOut, cosOut);
+			return;
+		}
+		*sinOut = sinf(angle);
+		*cosOut = cosf(angle);
+	}
+	/// <summary>
+	/// Resizes meshData's arrays to size. Keeps their capacity, so reusing a MeshData for smaller or equal meshes does not allocate
+	/// </summary>
+	/// <returns>True if the indices go in indices16</returns>
+	static bool resizeMeshData(MeshData* meshData, MeshSize size) {
+		const bool use16Bit = size.numVertices <= MAX_16BIT_VERTICES;
+		meshData->vertices.resize(size.numVertices);
+		meshData->indices.resize(use16Bit ? 0 : size.numIndices);
+		meshData->indices16.resize(use16Bit ? size.numIndices : 0);
+		return use16Bit;
+	}
+	/// <summary>
+	/// Bounds of a generated shape centered on the origin, from its parameters instead of its vertices
+	/// </summary>
+	static void setBounds(MeshData* meshData, const Vec3& halfExtents, float radius) {
+		meshData->bounds = CenteredBounds(Vec3(fabsf(halfExtents.x), fabsf(halfExtents.y), fabsf(halfExtents.z)), fabsf(radius));
+		meshData->hasBounds = true;
+	}
+
+	MeshSize getCubeSize() {
+		return { 24, 36 }; //6 x 4 vertices, 6 x 6 indices
+	}
+	MeshSize getPlaneSize(int subdivisions) {
+		size_t columns = subdivisions + 1;
+		return { columns * columns, (size_t)subdivisions * subdivisions * 6 };
+	}
+	MeshSize getSphereSize(int subdivisions) {
+		size_t columns = subdivisions + 1;
+		//Top and bottom caps are one triangle per column, rows in between are quads
+		size_t numSideRows = subdivisions > 2 ? subdivisions - 2 : 0;
+		return { columns * columns, (size_t)subdivisions * 6 + numSideRows * subdivisions * 6 };
+	}
+	MeshSize getCylinderSize(int subdivisions) {
+		size_t columns = subdivisions + 1;
+		//Center vertices + 4 rings. One cap triangle per column at each end and one quad per column for the side
+		return { columns * 4 + 2, columns * 12 };
+	}
+	MeshSize getIcosphereSize(int level) {
+		//Each level splits every triangle into 4, adding a vertex per edge (30 edges at level 0)
+		size_t numTriangles = (size_t)20 << (2 * std::max(level, 0));
+		return { numTriangles / 2 + 2, numTriangles * 3 };
+	}
+	MeshSize getCubeSphereSize(int subdivisions) {
+		size_t columns = subdivisions + 1;
+		return { 6 * columns * columns, (size_t)6 * subdivisions * subdivisions * 6 };
+	}
+
 	/// <summary>
 	/// Helper function for createCube. Note that this is not meant to be used standalone
 	/// </summary>
 	/// <param name="normal">Normal direction of the face</param>
 	/// <param name="size">Width/height of the face</param>
-	/// <param name="mesh">MeshData struct to fill</param>
-	static void createCubeFace(ew::Vec3 normal, float size, MeshData* mesh) {
-		unsigned int startVertex = mesh->vertices.size();
+	/// <param name="startVertex">Index of the face's first vertex in the mesh</param>
+	/// <param name="vertices">4 vertices to fill</param>
+	/// <param name="indices">6 indices to fill</param>
+	template<typename Index>
+	static void createCubeFace(ew::Vec3 normal, float size, unsigned int startVertex, Vertex* vertices, Index* indices) {
 		ew::Vec3 a = ew::Vec3(normal.z, normal.x, normal.y); //U axis
 		ew::Vec3 b = ew::Cross(normal, a); //V axis
 		for (int i = 0; i < 4; i++)
@@ -25,213 +100,536 @@ namespace ew {
 			ew::Vec3 pos = normal * size * 0.5f;
 			pos -= (a + b) * size * 0.5f;
 			pos += (a * col + b * row) * size;
-			Vertex vertex;// = &mesh->vertices[mesh->vertices.size()];
+			Vertex& vertex = vertices[i];
 			vertex.pos = pos;
 			vertex.normal = normal;
 			vertex.uv = ew::Vec2(col, row);
-			mesh->vertices.push_back(vertex);
 		}
 
 		//Indices
-		mesh->indices.push_back(startVertex);
-		mesh->indices.push_back(startVertex + 1);
-		mesh->indices.push_back(startVertex + 3);
-		mesh->indices.push_back(startVertex + 3);
-		mesh->indices.push_back(startVertex + 2);
-		mesh->indices.push_back(startVertex);
+		indices[0] = startVertex;
+		indices[1] = startVertex + 1;
+		indices[2] = startVertex + 3;
+		indices[3] = startVertex + 3;
+		indices[4] = startVertex + 2;
+		indices[5] = startVertex;
 	}
 	/// <summary>
 	/// Creates a cube of uniform size
 	/// </summary>
 	/// <param name="size">Total width, height, depth</param>
-	/// <param name="mesh">MeshData struct to fill. Will be cleared.</param>
+	/// <param name="verticesOut">Room for getCubeSize().numVertices</param>
+	/// <param name="indicesOut">Room for getCubeSize().numIndices</param>
+	template<typename Index>
+	static void fillCube(float size, Vertex* verticesOut, Index* indicesOut) {
+		const ew::Vec3 normals[6] = {
+			ew::Vec3{ +0.0f,+0.0f,+1.0f }, //Front
+			ew::Vec3{ +1.0f,+0.0f,+0.0f }, //Right
+			ew::Vec3{ +0.0f,+1.0f,+0.0f }, //Top
+			ew::Vec3{ -1.0f,+0.0f,+0.0f }, //Left
+			ew::Vec3{ +0.0f,-1.0f,+0.0f }, //Bottom
+			ew::Vec3{ +0.0f,+0.0f,-1.0f } //Back
+		};
+		for (int i = 0; i < 6; i++)
+		{
+			createCubeFace(normals[i], size, i * 4, verticesOut + i * 4, indicesOut + i * 6);
+		}
+	}
+	void createCube(float size, Vertex* verticesOut, unsigned int* indicesOut) {
+		fillCube(size, verticesOut, indicesOut);
+	}
+	void createCube(float size, Vertex* verticesOut, unsigned short* indicesOut) {
+		fillCube(size, verticesOut, indicesOut);
+	}
+	void createCube(float size, MeshData* meshData) {
+		if (resizeMeshData(meshData, getCubeSize()))
+			fillCube(size, meshData->vertices.data(), meshData->indices16.data());
+		else
+			fillCube(size, meshData->vertices.data(), meshData->indices.data());
+		setBounds(meshData, Vec3(size * 0.5f), size * 0.5f * sqrtf(3.0f));
+	}
 	MeshData createCube(float size) {
 		MeshData mesh;
-		mesh.vertices.reserve(24); //6 x 4 vertices
-		mesh.indices.reserve(36); //6 x 6 indices
-		createCubeFace(ew::Vec3{ +0.0f,+0.0f,+1.0f }, size, &mesh); //Front
-		createCubeFace(ew::Vec3{ +1.0f,+0.0f,+0.0f }, size, &mesh); //Right
-		createCubeFace(ew::Vec3{ +0.0f,+1.0f,+0.0f }, size, &mesh); //Top
-		createCubeFace(ew::Vec3{ -1.0f,+0.0f,+0.0f }, size, &mesh); //Left
-		createCubeFace(ew::Vec3{ +0.0f,-1.0f,+0.0f }, size, &mesh); //Bottom
-		createCubeFace(ew::Vec3{ +0.0f,+0.0f,-1.0f }, size, &mesh); //Back
+		createCube(size, &mesh);
 		return mesh;
 	}
-	MeshData createPlane(float width, float height, int subdivisions)
+
+	template<typename Index>
+	static void fillPlane(float width, float height, int subdivisions, Vertex* verticesOut, Index* indicesOut, int maxThreads)
 	{
-		//VERTICES
-		MeshData mesh;
-		int columns = subdivisions + 1;
-		for (size_t row = 0; row <= subdivisions; row++)
-		{
-			for (size_t col = 0; col <= subdivisions; col++)
-			{
-				Vertex v;
-				v.uv.x = ((float)col / subdivisions);
-				v.uv.y = ((float)row / subdivisions);
-				v.pos.x = -width/2 + width * v.uv.x;
-				v.pos.y = 0;
-				v.pos.z = height/2 -height * v.uv.y;
-				v.normal = ew::Vec3(0, 1, 0);
-				mesh.vertices.push_back(v);
-			}
-		}
-		//INDICES
-		for (size_t row = 0; row < subdivisions; row++)
-		{
-			for (size_t col = 0; col < subdivisions; col++)
+		size_t columns = subdivisions + 1;
+		//Each row writes its own slice of the vertex and index arrays, so rows can be filled in any order
+		auto fillRows = [&](size_t rowBegin, size_t rowEnd) {
+			for (size_t row = rowBegin; row < rowEnd; row++)
 			{
-				int start = row * columns + col;
-				mesh.indices.push_back(start);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns + 1);
-				mesh.indices.push_back(start + columns + 1);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start);
+				//VERTICES
+				for (size_t col = 0; col <= subdivisions; col++)
+				{
+					Vertex& v = verticesOut[row * columns + col];
+					v.uv.x = ((float)col / subdivisions);
+					v.uv.y = ((float)row / subdivisions);
+					v.pos.x = -width/2 + width * v.uv.x;
+					v.pos.y = 0;
+					v.pos.z = height/2 -height * v.uv.y;
+					v.normal = ew::Vec3(0, 1, 0);
+				}
+				//INDICES
+				if (row == subdivisions)
+					continue;
+				Index* indices = indicesOut + row * subdivisions * 6;
+				for (size_t col = 0; col < subdivisions; col++)
+				{
+					unsigned int start = row * columns + col;
+					*indices++ = start;
+					*indices++ = start + 1;
+					*indices++ = start + columns + 1;
+					*indices++ = start + columns + 1;
+					*indices++ = start + columns;
+					*indices++ = start;
+				}
 			}
-		}
-		return mesh;
+		};
+		parallelFor(columns, rowsPerJob(columns), std::cref(fillRows), maxThreads);
+	}
+	void createPlane(float width, float height, int subdivisions, Vertex* verticesOut, unsigned int* indicesOut, int maxThreads)
+	{
+		fillPlane(width, height, subdivisions, verticesOut, indicesOut, maxThreads);
+	}
+	void createPlane(float width, float height, int subdivisions, Vertex* verticesOut, unsigned short* indicesOut, int maxThreads)
+	{
+		fillPlane(width, height, subdivisions, verticesOut, indicesOut, maxThreads);
 	}
-	MeshData createSphere(float radius, int subdivisions)
+	void createPlane(float width, float height, int subdivisions, MeshData* meshData, int maxThreads)
+	{
+		if (resizeMeshData(meshData, getPlaneSize(subdivisions)))
+			fillPlane(width, height, subdivisions, meshData->vertices.data(), meshData->indices16.data(), maxThreads);
+		else
+			fillPlane(width, height, subdivisions, meshData->vertices.data(), meshData->indices.data(), maxThreads);
+		setBounds(meshData, Vec3(width * 0.5f, 0.0f, height * 0.5f), 0.5f * sqrtf(width * width + height * height));
+	}
+	MeshData createPlane(float width, float height, int subdivisions, int maxThreads)
 	{
 		MeshData mesh;
+		createPlane(width, height, subdivisions, &mesh, maxThreads);
+		return mesh;
+	}
+
+	template<typename Index>
+	static void fillSphere(float radius, int subdivisions, Vertex* verticesOut, Index* indicesOut, bool fastTrig, int maxThreads)
+	{
+		size_t columns = subdivisions + 1;
 		//VERTICES
 		float thetaStep = ew::TAU / subdivisions;
 		float phiStep = ew::PI / subdivisions;
-		for (size_t row = 0; row <= subdivisions; row++)
+		//Trig only depends on the row (phi) or the column (theta), so it is computed once per row/column instead of per vertex.
+		//The column values are kept in the uvs of the first row (the top pole, which is built last) so no extra memory is needed
+		for (size_t col = 0; col <= subdivisions; col++)
 		{
-			float phi = row * phiStep;
+			Vec2& column = verticesOut[col].uv;
+			sinCos(col * thetaStep, fastTrig, &column.y, &column.x);
+		}
+		auto createRow = [&](size_t row) {
+			float sinPhi, cosPhi;
+			sinCos(row * phiStep, fastTrig, &sinPhi, &cosPhi);
 			for (size_t col = 0; col <= subdivisions; col++)
 			{
-				float theta = thetaStep * col;
-				Vertex v;
-				v.normal.x = cosf(theta) * sinf(phi);
-				v.normal.y = cosf(phi);
-				v.normal.z = sinf(theta) * sinf(phi);
+				const Vec2 column = verticesOut[col].uv; //cos, sin of theta
+				Vertex& v = verticesOut[row * columns + col];
+				v.normal.x = column.x * sinPhi;
+				v.normal.y = cosPhi;
+				v.normal.z = column.y * sinPhi;
 				v.pos = v.normal * radius;
 				v.uv.x = (float)col / subdivisions;
 				v.uv.y = 1.0 - ((float)row / subdivisions);
-				mesh.vertices.push_back(v);
 			}
-		}
-		
+		};
+		auto fillRows = [&](size_t rowBegin, size_t rowEnd) {
+			for (size_t row = rowBegin + 1; row <= rowEnd; row++)
+			{
+				createRow(row);
+			}
+		};
+		parallelFor(subdivisions, rowsPerJob(columns), std::cref(fillRows), maxThreads);
+		createRow(0);
+
 		//INDICES
-		unsigned int columns = subdivisions + 1;
+		size_t capIndices = (size_t)subdivisions * 3;
+		size_t rowIndices = (size_t)subdivisions * 6;
+		size_t numSideRows = subdivisions > 2 ? subdivisions - 2 : 0;
+		Index* indices = indicesOut;
 		unsigned int sideStart = columns;
 		unsigned int poleStart = 0;
 		//Top cap
 		for (size_t i = 0; i < subdivisions; i++)
 		{
-			mesh.indices.push_back(sideStart + i);
-			mesh.indices.push_back(poleStart + i);
-			mesh.indices.push_back(sideStart +i+1);
+			*indices++ = sideStart + i;
+			*indices++ = poleStart + i;
+			*indices++ = sideStart +i+1;
 		}
-		//Rows of quads for sides
-		for (size_t row = 1; row < subdivisions - 1; row++)
-		{
-			for (size_t col = 0; col < subdivisions; col++)
+		//Rows of quads for sides. Side row r (starting at 1) fills its own slice after the top cap
+		auto fillSideRows = [&](size_t rowBegin, size_t rowEnd) {
+			for (size_t row = rowBegin + 1; row <= rowEnd; row++)
 			{
-				int start = row * columns + col;
-				mesh.indices.push_back(start);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns + 1);
+				Index* rowOut = indicesOut + capIndices + (row - 1) * rowIndices;
+				for (size_t col = 0; col < subdivisions; col++)
+				{
+					unsigned int start = row * columns + col;
+					*rowOut++ = start;
+					*rowOut++ = start + 1;
+					*rowOut++ = start + columns;
+					*rowOut++ = start + columns;
+					*rowOut++ = start + 1;
+					*rowOut++ = start + columns + 1;
+				}
 			}
-		}
+		};
+		parallelFor(numSideRows, rowsPerJob(columns), std::cref(fillSideRows), maxThreads);
 		//Bottom cap
+		indices += rowIndices * numSideRows;
 		poleStart = (columns * columns) - columns;
 		sideStart = poleStart - columns;
 		for (size_t i = 0; i < subdivisions; i++)
 		{
-			mesh.indices.push_back(sideStart + i);
-			mesh.indices.push_back(sideStart + i + 1);
-			mesh.indices.push_back(poleStart + i);
+			*indices++ = sideStart + i;
+			*indices++ = sideStart + i + 1;
+			*indices++ = poleStart + i;
 		}
+	}
+	void createSphere(float radius, int subdivisions, Vertex* verticesOut, unsigned int* indicesOut, bool fastTrig, int maxThreads)
+	{
+		fillSphere(radius, subdivisions, verticesOut, indicesOut, fastTrig, maxThreads);
+	}
+	void createSphere(float radius, int subdivisions, Vertex* verticesOut, unsigned short* indicesOut, bool fastTrig, int maxThreads)
+	{
+		fillSphere(radius, subdivisions, verticesOut, indicesOut, fastTrig, maxThreads);
+	}
+	void createSphere(float radius, int subdivisions, MeshData* meshData, bool fastTrig, int maxThreads)
+	{
+		if (resizeMeshData(meshData, getSphereSize(subdivisions)))
+			fillSphere(radius, subdivisions, meshData->vertices.data(), meshData->indices16.data(), fastTrig, maxThreads);
+		else
+			fillSphere(radius, subdivisions, meshData->vertices.data(), meshData->indices.data(), fastTrig, maxThreads);
+		setBounds(meshData, Vec3(radius), radius);
+	}
+	MeshData createSphere(float radius, int subdivisions, bool fastTrig, int maxThreads)
+	{
+		MeshData mesh;
+		createSphere(radius, subdivisions, &mesh, fastTrig, maxThreads);
 		return mesh;
 	}
-	void createCylinderRing(MeshData* meshData, float radius, int subdivisions, float y, bool sideFacing) {
-		float thetaStep = ew::TAU / subdivisions;
-		for (size_t i = 0; i <= subdivisions; i++)
-		{
-			float theta = i * thetaStep;
-			float cosA = cosf(theta);
-			float sinA = sinf(theta);
-			ew::Vertex v;
-			v.pos = ew::Vec3(cosA * radius, y, sinA * radius);
-			if (sideFacing) {
-				v.normal = ew::Vec3(cosA, 0, sinA);
-				v.uv = ew::Vec2((float)i / subdivisions, y > 0 ? 1 : 0);
-			}
-			else {
-				v.normal = ew::Vec3(0, ew::Sign(y), 0);
-				v.uv = ew::Vec2(cosA * 0.5 + 0.5, sinA * 0.5 + 0.5);
-			}
 
-			meshData->vertices.push_back(v);
+	/// <summary>
+	/// Helper function for createCylinder. Fills vertex i of one ring
+	/// </summary>
+	/// <param name="sideFacing">Normal points out from the side instead of along Y (caps)</param>
+	static void createCylinderRingVertex(Vertex* v, size_t i, float radius, int subdivisions, float y, bool sideFacing, float sinA, float cosA) {
+		v->pos = ew::Vec3(cosA * radius, y, sinA * radius);
+		if (sideFacing) {
+			v->normal = ew::Vec3(cosA, 0, sinA);
+			v->uv = ew::Vec2((float)i / subdivisions, y > 0 ? 1 : 0);
+		}
+		else {
+			v->normal = ew::Vec3(0, ew::Sign(y), 0);
+			v->uv = ew::Vec2(cosA * 0.5 + 0.5, sinA * 0.5 + 0.5);
 		}
 	}
-	MeshData createCylinder(float radius, float height, int subdivisions)
+	template<typename Index>
+	static void fillCylinder(float radius, float height, int subdivisions, Vertex* verticesOut, Index* indicesOut, bool fastTrig, int maxThreads)
 	{
-		MeshData mesh;
+		//Top center, 4 rings (top cap, top side, bottom side, bottom cap), bottom center
+		size_t columns = subdivisions + 1;
+		//All 4 rings share the same angles
+		float step = ew::TAU / subdivisions;
 
+		const float topY = height * 0.5;
+		const float bottomY = -topY;
 		//VERTICES
+		unsigned int bottomIndex = columns * 4 + 1;
 		{
-			const float topY = height * 0.5;
-			const float bottomY = -topY;
-
-			ew::Vertex topVertex;
+			ew::Vertex& topVertex = verticesOut[0];
 			topVertex.pos = ew::Vec3(0, topY, 0);
 			topVertex.normal = ew::Vec3(0, 1, 0);
 			topVertex.uv = ew::Vec2(0.5);
-			mesh.vertices.push_back(topVertex);
-
-			createCylinderRing(&mesh, radius, subdivisions, topY, false);
-			createCylinderRing(&mesh, radius, subdivisions, topY, true);
-			createCylinderRing(&mesh, radius, subdivisions, bottomY, true);
-			createCylinderRing(&mesh, radius, subdivisions, bottomY, false);
 
-			ew::Vertex bottomVertex;
+			ew::Vertex& bottomVertex = verticesOut[bottomIndex];
 			bottomVertex.pos = ew::Vec3(0, bottomY, 0);
 			bottomVertex.normal = ew::Vec3(0, -1, 0);
 			bottomVertex.uv = ew::Vec2(0.5);
-			mesh.vertices.push_back(bottomVertex);
 		}
-		
-
-		//INDICES
-		{
-			int columns = subdivisions + 1;
-			//Top cap
-			for (size_t i = 0; i < columns; i++)
+		unsigned int sideStart = columns;
+		unsigned int bottomSideStart = bottomIndex - columns;
+		//Each job fills the same range of columns in every ring, and the indices that start at those columns
+		auto fillColumns = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
 			{
-				mesh.indices.push_back(0);
-				mesh.indices.push_back(i + 1);
-				mesh.indices.push_back(i);
+				//VERTICES
+				float sinA, cosA;
+				sinCos(i * step, fastTrig, &sinA, &cosA);
+				createCylinderRingVertex(&verticesOut[1 + i], i, radius, subdivisions, topY, false, sinA, cosA);
+				createCylinderRingVertex(&verticesOut[1 + columns + i], i, radius, subdivisions, topY, true, sinA, cosA);
+				createCylinderRingVertex(&verticesOut[1 + columns * 2 + i], i, radius, subdivisions, bottomY, true, sinA, cosA);
+				createCylinderRingVertex(&verticesOut[1 + columns * 3 + i], i, radius, subdivisions, bottomY, false, sinA, cosA);
+
+				//INDICES
+				//Top cap
+				Index* indices = indicesOut + i * 3;
+				indices[0] = 0;
+				indices[1] = i + 1;
+				indices[2] = i;
+				//Sides
+				unsigned int start = sideStart + i;
+				indices = indicesOut + columns * 3 + i * 6;
+				indices[0] = start;
+				indices[1] = start + 1;
+				indices[2] = start + columns;
+				indices[3] = start + columns;
+				indices[4] = start + 1;
+				indices[5] = start + columns + 1;
+				//Bottom cap
+				indices = indicesOut + columns * 9 + i * 3;
+				indices[0] = bottomIndex;
+				indices[1] = bottomSideStart + i;
+				indices[2] = bottomSideStart + i + 1;
 			}
-			int sideStart = columns;
-			//Sides
-			for (size_t i = 0; i < columns; i++)
+		};
+		parallelFor(columns, rowsPerJob(4), std::cref(fillColumns), maxThreads);
+	}
+	void createCylinder(float radius, float height, int subdivisions, Vertex* verticesOut, unsigned int* indicesOut, bool fastTrig, int maxThreads)
+	{
+		fillCylinder(radius, height, subdivisions, verticesOut, indicesOut, fastTrig, maxThreads);
+	}
+	void createCylinder(float radius, float height, int subdivisions, Vertex* verticesOut, unsigned short* indicesOut, bool fastTrig, int maxThreads)
+	{
+		fillCylinder(radius, height, subdivisions, verticesOut, indicesOut, fastTrig, maxThreads);
+	}
+	void createCylinder(float radius, float height, int subdivisions, MeshData* meshData, bool fastTrig, int maxThreads)
+	{
+		if (resizeMeshData(meshData, getCylinderSize(subdivisions)))
+			fillCylinder(radius, height, subdivisions, meshData->vertices.data(), meshData->indices16.data(), fastTrig, maxThreads);
+		else
+			fillCylinder(radius, height, subdivisions, meshData->vertices.data(), meshData->indices.data(), fastTrig, maxThreads);
+		setBounds(meshData, Vec3(radius, height * 0.5f, radius), sqrtf(radius * radius + height * height * 0.25f));
+	}
+	MeshData createCylinder(float radius, float height, int subdivisions, bool fastTrig, int maxThreads)
+	{
+		MeshData mesh;
+		createCylinder(radius, height, subdivisions, &mesh, fastTrig, maxThreads);
+		return mesh;
+	}
+
+	/// <summary>
+	/// Spherical normal and uv for a unit direction, matching createSphere (u = angle around y, v = 1 at the top)
+	/// </summary>
+	static void setSphereVertex(Vertex* v, const Vec3& direction, float radius) {
+		v->normal = direction;
+		v->pos = direction * radius;
+		v->uv.x = atan2f(direction.z, direction.x) / ew::TAU;
+		if (v->uv.x < 0.0f)
+			v->uv.x += 1.0f;
+		v->uv.y = 1.0f - acosf(std::min(std::max(direction.y, -1.0f), 1.0f)) / ew::PI;
+	}
+
+	/// <summary>
+	/// Closest point to the origin on triangle abc (Ericson, Real-Time Collision Detection 5.1.5)
+	/// </summary>
+	static Vec3 closestPointToOrigin(const Vec3& a, const Vec3& b, const Vec3& c) {
+		const Vec3 ab = b - a, ac = c - a, ap = -a;
+		const float d1 = ew::Dot(ab, ap), d2 = ew::Dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return a;
+		const Vec3 bp = -b;
+		const float d3 = ew::Dot(ab, bp), d4 = ew::Dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3)
+			return b;
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return a + ab * (d1 / (d1 - d3));
+		const Vec3 cp = -c;
+		const float d5 = ew::Dot(ab, cp), d6 = ew::Dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6)
+			return c;
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return a + ac * (d2 / (d2 - d6));
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		const float denom = 1.0f / (va + vb + vc);
+		return a + ab * (vb * denom) + ac * (vc * denom);
+	}
+	float getSphereError(const MeshData& meshData, float radius)
+	{
+		float maxError = 0.0f;
+		for (size_t i = 0; i + 2 < meshData.getNumIndices(); i += 3)
+		{
+			const Vec3& a = meshData.vertices[meshData.getIndex(i)].pos;
+			const Vec3& b = meshData.vertices[meshData.getIndex(i + 1)].pos;
+			const Vec3& c = meshData.vertices[meshData.getIndex(i + 2)].pos;
+			//Degenerate triangles (createSphere's poles) cover no surface
+			if (ew::Magnitude(ew::Cross(b - a, c - a)) == 0.0f)
+				continue;
+			maxError = std::max(maxError, radius - ew::Magnitude(closestPointToOrigin(a, b, c)));
+		}
+		return maxError;
+	}
+
+	/// <summary>
+	/// Starts from an icosahedron and splits every triangle into 4 per level, pushing the new edge midpoints out onto the sphere.
+	/// Triangles on both sides of an edge share its midpoint through a cache keyed by the edge's vertex pair.
+	/// Vertices are written in creation order, so the 12 icosahedron corners come first
+	/// </summary>
+	void createIcosphere(float radius, int level, MeshData* meshData)
+	{
+		level = std::max(level, 0);
+		MeshSize size = getIcosphereSize(level);
+		meshData->vertices.resize(size.numVertices);
+		std::vector<Vec3> directions;
+		directions.reserve(size.numVertices);
+
+		const float t = (1.0f + sqrtf(5.0f)) / 2.0f;
+		const Vec3 corners[12] = {
+			Vec3(-1, t, 0), Vec3(1, t, 0), Vec3(-1, -t, 0), Vec3(1, -t, 0),
+			Vec3(0, -1, t), Vec3(0, 1, t), Vec3(0, -1, -t), Vec3(0, 1, -t),
+			Vec3(t, 0, -1), Vec3(t, 0, 1), Vec3(-t, 0, -1), Vec3(-t, 0, 1)
+		};
+		for (int i = 0; i < 12; i++)
+		{
+			directions.push_back(ew::Normalize(corners[i]));
+		}
+		std::vector<unsigned int> triangles = {
+			0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+			1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+			3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+			4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+		};
+		triangles.reserve(size.numIndices);
+		std::vector<unsigned int> split;
+		split.reserve(size.numIndices);
+		std::unordered_map<uint64_t, unsigned int> midpoints;
+
+		auto getMidpoint = [&](unsigned int a, unsigned int b) {
+			const uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+			auto it = midpoints.find(key);
+			if (it != midpoints.end())
+				return it->second;
+			unsigned int index = directions.size();
+			directions.push_back(ew::Normalize(directions[a] + directions[b]));
+			midpoints.emplace(key, index);
+			return index;
+		};
+		for (int i = 0; i < level; i++)
+		{
+			midpoints.clear();
+			midpoints.reserve(triangles.size() / 2);
+			split.clear();
+			for (size_t j = 0; j < triangles.size(); j += 3)
 			{
-				int start = sideStart + i;
-				mesh.indices.push_back(start);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns + 1);
+				unsigned int a = triangles[j], b = triangles[j + 1], c = triangles[j + 2];
+				unsigned int ab = getMidpoint(a, b), bc = getMidpoint(b, c), ca = getMidpoint(c, a);
+				unsigned int children[12] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+				split.insert(split.end(), children, children + 12);
 			}
-			//Bottom cap
-			int bottomIndex = mesh.vertices.size() - 1;
-			sideStart = bottomIndex - columns;
-			for (size_t i = 0; i < columns; i++)
+			triangles.swap(split);
+		}
+
+		for (size_t i = 0; i < directions.size(); i++)
+		{
+			setSphereVertex(&meshData->vertices[i], directions[i], radius);
+		}
+		const bool use16Bit = size.numVertices <= MAX_16BIT_VERTICES;
+		meshData->indices.clear();
+		meshData->indices16.clear();
+		if (use16Bit)
+			meshData->indices16.assign(triangles.begin(), triangles.end());
+		else
+			meshData->indices.swap(triangles);
+		setBounds(meshData, Vec3(radius), radius);
+	}
+	MeshData createIcosphere(float radius, int level)
+	{
+		MeshData mesh;
+		createIcosphere(radius, level, &mesh);
+		return mesh;
+	}
+
+	/// <summary>
+	/// Each face is a grid like createPlane, laid on a cube face and pushed out onto the sphere with
+	/// p * sqrt(1 - q^2/2 - r^2/2 + q^2r^2/3) per component (p, q, r being the other components), which spreads
+	/// vertices more evenly than normalizing. Rows of all 6 faces are filled in parallel
+	/// </summary>
+	template<typename Index>
+	static void fillCubeSphere(float radius, int subdivisions, Vertex* verticesOut, Index* indicesOut, int maxThreads)
+	{
+		const size_t cells = (size_t)subdivisions; //Per face side, as size_t for the loops below
+		size_t columns = cells + 1;
+		//Face normal, then the directions columns and rows advance in. normal = u x v so triangles face outward
+		const Vec3 faces[6][3] = {
+			{ Vec3(0, 0, 1), Vec3(1, 0, 0), Vec3(0, 1, 0) },
+			{ Vec3(1, 0, 0), Vec3(0, 0, -1), Vec3(0, 1, 0) },
+			{ Vec3(0, 0, -1), Vec3(-1, 0, 0), Vec3(0, 1, 0) },
+			{ Vec3(-1, 0, 0), Vec3(0, 0, 1), Vec3(0, 1, 0) },
+			{ Vec3(0, 1, 0), Vec3(1, 0, 0), Vec3(0, 0, -1) },
+			{ Vec3(0, -1, 0), Vec3(1, 0, 0), Vec3(0, 0, 1) }
+		};
+		auto fillRows = [&](size_t rowBegin, size_t rowEnd) {
+			for (size_t faceRow = rowBegin; faceRow < rowEnd; faceRow++)
 			{
-				mesh.indices.push_back(bottomIndex);
-				mesh.indices.push_back(sideStart + i);
-				mesh.indices.push_back(sideStart + i + 1);
+				const size_t face = faceRow / columns;
+				const size_t row = faceRow % columns;
+				const Vec3* axes = faces[face];
+				//VERTICES
+				for (size_t col = 0; col <= cells; col++)
+				{
+					Vertex& v = verticesOut[faceRow * columns + col];
+					v.uv.x = (float)col / subdivisions;
+					v.uv.y = (float)row / subdivisions;
+					Vec3 p = axes[0] + axes[1] * (v.uv.x * 2.0f - 1.0f) + axes[2] * (v.uv.y * 2.0f - 1.0f);
+					Vec3 p2 = Vec3(p.x * p.x, p.y * p.y, p.z * p.z);
+					v.normal = ew::Normalize(Vec3(
+						p.x * sqrtf(1.0f - p2.y / 2.0f - p2.z / 2.0f + p2.y * p2.z / 3.0f),
+						p.y * sqrtf(1.0f - p2.z / 2.0f - p2.x / 2.0f + p2.z * p2.x / 3.0f),
+						p.z * sqrtf(1.0f - p2.x / 2.0f - p2.y / 2.0f + p2.x * p2.y / 3.0f)
+					));
+					v.pos = v.normal * radius;
+				}
+				//INDICES
+				if (row == cells)
+					continue;
+				Index* indices = indicesOut + (face * subdivisions + row) * subdivisions * 6;
+				for (size_t col = 0; col < cells; col++)
+				{
+					unsigned int start = faceRow * columns + col;
+					*indices++ = start;
+					*indices++ = start + 1;
+					*indices++ = start + columns + 1;
+					*indices++ = start + columns + 1;
+					*indices++ = start + columns;
+					*indices++ = start;
+				}
 			}
-		}
+		};
+		parallelFor(6 * columns, rowsPerJob(columns), std::cref(fillRows), maxThreads);
+	}
+	void createCubeSphere(float radius, int subdivisions, Vertex* verticesOut, unsigned int* indicesOut, int maxThreads)
+	{
+		fillCubeSphere(radius, subdivisions, verticesOut, indicesOut, maxThreads);
+	}
+	void createCubeSphere(float radius, int subdivisions, Vertex* verticesOut, unsigned short* indicesOut, int maxThreads)
+	{
+		fillCubeSphere(radius, subdivisions, verticesOut, indicesOut, maxThreads);
+	}
+	void createCubeSphere(float radius, int subdivisions, MeshData* meshData, int maxThreads)
+	{
+		if (resizeMeshData(meshData, getCubeSphereSize(subdivisions)))
+			fillCubeSphere(radius, subdivisions, meshData->vertices.data(), meshData->indices16.data(), maxThreads);
+		else
+			fillCubeSphere(radius, subdivisions, meshData->vertices.data(), meshData->indices.data(), maxThreads);
+		setBounds(meshData, Vec3(radius), radius);
+	}
+	MeshData createCubeSphere(float radius, int subdivisions, int maxThreads)
+	{
+		MeshData mesh;
+		createCubeSphere(radius, subdivisions, &mesh, maxThreads);
 		return mesh;
 	}
 }
\ No newline at end of file
@@ -7,8 +7,57 @@
 #include "mesh.h"
 
 namespace ew {
+	//Exact sizes of the meshes created below, for the same parameters
+	MeshSize getCubeSize();
+	MeshSize getPlaneSize(int subdivisions);
+	MeshSize getSphereSize(int subdivisions);
+	MeshSize getCylinderSize(int subdivisions);
+	MeshSize getIcosphereSize(int level);
+	MeshSize getCubeSphereSize(int subdivisions);
+
+	//Each generator has 3 forms:
+	//	Returning a new MeshData
+	//	Filling a MeshData*, which is resized to fit. Reusing one keeps its capacity, so regenerating doesn't allocate
+	//	Filling caller buffers (an arena, a mapped GPU buffer...) with room for get*Size(). Doesn't allocate at all.
+	//	16 bit index buffers are only valid when get*Size().numVertices <= MAX_16BIT_VERTICES
+	//The MeshData forms store indices in indices16 when the vertex count allows it, and set MeshData::bounds from the parameters.
+	//Large meshes are split across the job threads by row. maxThreads: 1 = calling thread only, <= 0 = all job threads.
+	//The output is identical for any thread count.
+	//fastTrig: use ew::FastSinCos (~1e-7 error) instead of sinf/cosf
 	MeshData createCube(float size);
-	MeshData createPlane(float width, float height, int subdivisions);
-	MeshData createSphere(float radius, int subdivisions);
-	MeshData createCylinder(float radius, float height, int subdivisions);
-}
+	void createCube(float size, MeshData* meshData);
+	void createCube(float size, Vertex* verticesOut, unsigned int* indicesOut);
+	void createCube(float size, Vertex* verticesOut, unsigned short* indicesOut);
+
+	MeshData createPlane(float width, float height, int subdivisions, int maxThreads = 0);
+	void createPlane(float width, float height, int subdivisions, MeshData* meshData, int maxThreads = 0);
+	void createPlane(float width, float height, int subdivisions, Vertex* verticesOut, unsigned int* indicesOut, int maxThreads = 0);
+	void createPlane(float width, float height, int subdivisions, Vertex* verticesOut, unsigned short* indicesOut, int maxThreads = 0);
+
+	MeshData createSphere(float radius, int subdivisions, bool fastTrig = false, int maxThreads = 0);
+	void createSphere(float radius, int subdivisions, MeshData* meshData, bool fastTrig = false, int maxThreads = 0);
+	void createSphere(float radius, int subdivisions, Vertex* verticesOut, unsigned int* indicesOut, bool fastTrig = false, int maxThreads = 0);
+	void createSphere(float radius, int subdivisions, Vertex* verticesOut, unsigned short* indicesOut, bool fastTrig = false, int maxThreads = 0);
+
+	MeshData createCylinder(float radius, float height, int subdivisions, bool fastTrig = false, int maxThreads = 0);
+	void createCylinder(float radius, float height, int subdivisions, MeshData* meshData, bool fastTrig = false, int maxThreads = 0);
+	void createCylinder(float radius, float height, int subdivisions, Vertex* verticesOut, unsigned int* indicesOut, bool fastTrig = false, int maxThreads = 0);
+	void createCylinder(float radius, float height, int subdivisions, Vertex* verticesOut, unsigned short* indicesOut, bool fastTrig = false, int maxThreads = 0);
+
+	//Spheres that need far fewer triangles than createSphere for the same roundness, since they don't bunch up at the poles.
+	//Icosphere: level 0 is the 20 triangle icosahedron, each level splits every triangle into 4.
+	//UVs are spherical like createSphere's, but there are no seam vertices, so textures show a seam.
+	//Only the MeshData forms exist, since sharing edge midpoints needs scratch memory anyway
+	MeshData createIcosphere(float radius, int level);
+	void createIcosphere(float radius, int level, MeshData* meshData);
+
+	//Largest distance between the surface of a sphere mesh made by any of the generators above and the true sphere.
+	//All vertices lie on the sphere, so this is how far the flattest part of a triangle sags toward the center. Used as an LOD error
+	float getSphereError(const MeshData& meshData, float radius);
+
+	//Cube sphere: a cube with subdivisions x subdivisions quads per face, pushed out onto the sphere. Each face has its own 0-1 UVs
+	MeshData createCubeSphere(float radius, int subdivisions, int maxThreads = 0);
+	void createCubeSphere(float radius, int subdivisions, MeshData* meshData, int maxThreads = 0);
+	void createCubeSphere(float radius, int subdivisions, Vertex* verticesOut, unsigned int* indicesOut, int maxThreads = 0);
+	void createCubeSphere(float radius, int subdivisions, Vertex* verticesOut, unsigned short* indicesOut, int maxThreads = 0);
+}
\ No newline at end of file
@@ -119,9 +119,21 @@ namespace ew {
 	{
 		setVec4(name, v.x, v.y, v.z, v.w);
 	}
+	void Shader::setMat3(const std::string& name, const ew::Mat3& m) const
+	{
+		glUniformMatrix3fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, &m[0].x);
+	}
 	void Shader::setMat4(const std::string& name, const ew::Mat4& m) const
 	{
 		glUniformMatrix4fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, &m[0][0]);
 	}
+	/// <summary>
+	/// Sets a mat3x4 uniform from an affine transform. Each row of m becomes a column of the GLSL matrix,
+	/// so in the shader a point is transformed with vec4(p, 1.0) * m.
+	/// </summary>
+	void Shader::setMat3x4(const std::string& name, const ew::Affine3x4& m) const
+	{
+		glUniformMatrix3x4fv(glGetUniformLocation(m_id, name.c_str()), 1, GL_FALSE, &m[0].x);
+	}
 }
 
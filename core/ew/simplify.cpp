@@ -0,0 +1,620 @@
+#include "simplify.h"
+#include "jobs.h"
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <float.h>
+#include <string.h>
+
+namespace ew {
+	static const unsigned int NONE = ~0u;
+	//Marks an open edge list that has more than one edge in a direction
+	static const unsigned int MULTIPLE = ~0u - 1;
+
+	//How a vertex may move. Manifold vertices can collapse into any neighbor, border and seam vertices only along their
+	//border/seam into another vertex of the same kind, locked vertices (corners, seam ends, non manifold) never move
+	enum VertexKind {
+		KIND_MANIFOLD,
+		KIND_BORDER,
+		KIND_SEAM,
+		KIND_LOCKED
+	};
+	static const bool CAN_COLLAPSE[4][4] = {
+		{ true, true, true, true },
+		{ false, true, false, false },
+		{ false, false, true, false },
+		{ false, false, false, false }
+	};
+
+	//Sum of squared distances to weighted planes, as a symmetric 4x4 matrix.
+	//Double precision: on dense meshes a collapse's error is many orders of magnitude below c and the other terms it is the
+	//difference of, and in float it cancels to 0, which would make maxError and the collapse order meaningless
+	struct Quadric {
+		double a00, a11, a22, a10, a20, a21;
+		double b0, b1, b2;
+		double c;
+		double weight;
+	};
+	static void addPlane(Quadric* q, const Vec3& normal, float distance, float weight) {
+		const double nx = normal.x, ny = normal.y, nz = normal.z, d = distance, w = weight;
+		q->a00 += w * nx * nx;
+		q->a11 += w * ny * ny;
+		q->a22 += w * nz * nz;
+		q->a10 += w * ny * nx;
+		q->a20 += w * nz * nx;
+		q->a21 += w * nz * ny;
+		q->b0 += w * nx * d;
+		q->b1 += w * ny * d;
+		q->b2 += w * nz * d;
+		q->c += w * d * d;
+		q->weight += w;
+	}
+	static void addQuadric(Quadric* q, const Quadric& r) {
+		q->a00 += r.a00; q->a11 += r.a11; q->a22 += r.a22;
+		q->a10 += r.a10; q->a20 += r.a20; q->a21 += r.a21;
+		q->b0 += r.b0; q->b1 += r.b1; q->b2 += r.b2;
+		q->c += r.c;
+		q->weight += r.weight;
+	}
+	//Weighted mean squared distance from p to the planes of a + b
+	static float getQuadricError(const Quadric& a, const Quadric& b, const Vec3& p) {
+		Quadric q = a;
+		addQuadric(&q, b);
+		const double x = p.x, y = p.y, z = p.z;
+		const double rx = q.a00 * x + 2.0 * (q.a10 * y + q.b0);
+		const double ry = q.a11 * y + 2.0 * (q.a21 * z + q.b1);
+		const double rz = q.a22 * z + 2.0 * (q.a20 * x + q.b2);
+		const double error = fabs(rx * x + ry * y + rz * z + q.c);
+		return (float)(q.weight > 0.0 ? error / q.weight : error);
+	}
+
+	//Half edges (or triangles) grouped by their first vertex, as one array with per vertex offsets
+	struct Adjacency {
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned int> data;
+	};
+	//Half edges a->b of every triangle, keyed by map[a] and storing map[b]
+	static void buildEdges(Adjacency* adjacency, const std::vector<unsigned int>& indices, size_t numVertices, const unsigned int* map) {
+		adjacency->offsets.assign(numVertices + 1, 0);
+		adjacency->data.resize(indices.size());
+		for (size_t i = 0; i < indices.size(); i++) {
+			adjacency->offsets[map[indices[i]] + 1]++;
+		}
+		for (size_t v = 0; v < numVertices; v++) {
+			adjacency->offsets[v + 1] += adjacency->offsets[v];
+		}
+		std::vector<unsigned int> fill(adjacency->offsets.begin(), adjacency->offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = map[indices[i + k]];
+				unsigned int b = map[indices[i + (k + 1) % 3]];
+				adjacency->data[fill[a]++] = b;
+			}
+		}
+	}
+	//Triangles touching each position
+	static void buildTriangles(Adjacency* adjacency, const std::vector<unsigned int>& indices, size_t numVertices, const unsigned int* remap) {
+		adjacency->offsets.assign(numVertices + 1, 0);
+		adjacency->data.resize(indices.size());
+		for (size_t i = 0; i < indices.size(); i++) {
+			adjacency->offsets[remap[indices[i]] + 1]++;
+		}
+		for (size_t v = 0; v < numVertices; v++) {
+			adjacency->offsets[v + 1] += adjacency->offsets[v];
+		}
+		std::vector<unsigned int> fill(adjacency->offsets.begin(), adjacency->offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++) {
+			adjacency->data[fill[remap[indices[i]]]++] = i / 3;
+		}
+	}
+	static bool hasEdge(const Adjacency& adjacency, unsigned int a, unsigned int b) {
+		for (unsigned int i = adjacency.offsets[a]; i < adjacency.offsets[a + 1]; i++) {
+			if (adjacency.data[i] == b)
+				return true;
+		}
+		return false;
+	}
+	static void addOpenEdge(unsigned int* slot, unsigned int vertex) {
+		*slot = *slot == NONE ? vertex : MULTIPLE;
+	}
+	static bool isSingle(unsigned int v) {
+		return v != NONE && v != MULTIPLE;
+	}
+
+	/// <summary>
+	/// State of one simplification. Works on vertex indices of the input mesh throughout; vertices are only dropped at the end
+	/// </summary>
+	class Simplifier {
+	public:
+		Simplifier(const MeshData& meshData);
+		void run(size_t targetIndexCount, float maxError);
+		MeshData getResult()const;
+		float getError()const { return sqrtf(m_error) * m_scale; }
+	private:
+		struct Collapse {
+			unsigned int from, to;
+			float error;
+		};
+		void buildPositions();
+		void classify();
+		void buildQuadrics();
+		bool canCollapse(unsigned int from, unsigned int to, unsigned int* seamFrom, unsigned int* seamTo)const;
+		bool hasFlips(unsigned int from, unsigned int to)const;
+		size_t collapsePass(size_t trianglesToRemove, float errorLimit);
+		void sortCollapses();
+		void remapLoops(std::vector<unsigned int>* loop)const;
+
+		const MeshData& m_meshData;
+		size_t m_numVertices;
+		std::vector<Vec3> m_positions; //Scaled into a unit box so errors don't depend on the mesh size
+		float m_scale = 1.0f;
+		std::vector<unsigned int> m_indices;
+		std::vector<unsigned int> m_remap; //First vertex with the same position
+		std::vector<unsigned int> m_wedge; //Next vertex with the same position, in a loop
+		std::vector<unsigned char> m_kind;
+		std::vector<unsigned int> m_loopOut, m_loopIn; //Open edges by vertex (seams)
+		std::vector<unsigned int> m_borderOut, m_borderIn; //Open edges by position (borders)
+		std::vector<Quadric> m_quadrics; //By position
+		std::vector<unsigned int> m_collapseRemap;
+		Adjacency m_triangles;
+		std::vector<Collapse> m_collapses;
+		std::vector<Collapse> m_sortBuffer;
+		std::vector<unsigned char> m_touched; //Positions that moved or received a collapse in this pass
+		std::vector<unsigned char> m_moved;
+		float m_error = 0.0f;
+	};
+
+	Simplifier::Simplifier(const MeshData& meshData)
+		:m_meshData(meshData), m_numVertices(meshData.vertices.size())
+	{
+		m_indices.resize(meshData.getNumIndices() / 3 * 3);
+		for (size_t i = 0; i < m_indices.size(); i++) {
+			m_indices[i] = meshData.getIndex(i);
+		}
+		buildPositions();
+		//Triangles with two corners at one position cover no area
+		size_t kept = 0;
+		for (size_t i = 0; i < m_indices.size(); i += 3) {
+			unsigned int a = m_remap[m_indices[i]], b = m_remap[m_indices[i + 1]], c = m_remap[m_indices[i + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+			memmove(&m_indices[kept], &m_indices[i], sizeof(unsigned int) * 3);
+			kept += 3;
+		}
+		m_indices.resize(kept);
+		classify();
+		buildQuadrics();
+	}
+
+	void Simplifier::buildPositions()
+	{
+		const std::vector<Vertex>& vertices = m_meshData.vertices;
+		m_positions.resize(m_numVertices);
+		if (m_numVertices == 0)
+			return;
+		Vec3 min = vertices[0].pos, max = vertices[0].pos;
+		for (const Vertex& v : vertices) {
+			min = Vec3(std::min(min.x, v.pos.x), std::min(min.y, v.pos.y), std::min(min.z, v.pos.z));
+			max = Vec3(std::max(max.x, v.pos.x), std::max(max.y, v.pos.y), std::max(max.z, v.pos.z));
+		}
+		m_scale = std::max(std::max(max.x - min.x, max.y - min.y), std::max(max.z - min.z, 1e-20f));
+		for (size_t v = 0; v < m_numVertices; v++) {
+			m_positions[v] = (vertices[v].pos - min) / m_scale;
+		}
+
+		//Vertices at equal positions share topology and quadrics. Adding 0 turns -0 into 0 so both hash the same
+		struct PositionHash {
+			const Vertex* vertices;
+			size_t operator()(unsigned int v)const {
+				const Vec3 pos = vertices[v].pos + Vec3(0.0f);
+				const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&pos);
+				size_t hash = 2166136261u;
+				for (size_t i = 0; i < sizeof(Vec3); i++) {
+					hash = (hash ^ bytes[i]) * 16777619u;
+				}
+				return hash;
+			}
+		};
+		struct PositionEqual {
+			const Vertex* vertices;
+			bool operator()(unsigned int a, unsigned int b)const {
+				const Vec3& pa = vertices[a].pos;
+				const Vec3& pb = vertices[b].pos;
+				return pa.x == pb.x && pa.y == pb.y && pa.z == pb.z;
+			}
+		};
+		std::unordered_map<unsigned int, unsigned int, PositionHash, PositionEqual> firstAt(m_numVertices, PositionHash{ vertices.data() }, PositionEqual{ vertices.data() });
+		m_remap.resize(m_numVertices);
+		m_wedge.resize(m_numVertices);
+		for (unsigned int v = 0; v < m_numVertices; v++) {
+			auto it = firstAt.find(v);
+			if (it == firstAt.end()) {
+				firstAt.emplace(v, v);
+				m_remap[v] = v;
+				m_wedge[v] = v;
+			}
+			else {
+				//Insert into the loop after the first vertex
+				unsigned int first = it->second;
+				m_remap[v] = first;
+				m_wedge[v] = m_wedge[first];
+				m_wedge[first] = v;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Finds the open edges (half edges without an opposite) of every vertex, both by vertex and by position.
+	/// Open by position is a mesh border; open by vertex only is a seam between vertices split for their attributes
+	/// </summary>
+	void Simplifier::classify()
+	{
+		m_loopOut.assign(m_numVertices, NONE);
+		m_loopIn.assign(m_numVertices, NONE);
+		m_borderOut.assign(m_numVertices, NONE);
+		m_borderIn.assign(m_numVertices, NONE);
+		std::vector<unsigned int> identity(m_numVertices);
+		for (unsigned int v = 0; v < m_numVertices; v++) {
+			identity[v] = v;
+		}
+		Adjacency byVertex, byPosition;
+		buildEdges(&byVertex, m_indices, m_numVertices, identity.data());
+		buildEdges(&byPosition, m_indices, m_numVertices, m_remap.data());
+		for (size_t i = 0; i < m_indices.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = m_indices[i + k];
+				unsigned int b = m_indices[i + (k + 1) % 3];
+				if (!hasEdge(byVertex, b, a)) {
+					addOpenEdge(&m_loopOut[a], b);
+					addOpenEdge(&m_loopIn[b], a);
+				}
+				if (!hasEdge(byPosition, m_remap[b], m_remap[a])) {
+					addOpenEdge(&m_borderOut[m_remap[a]], b);
+					addOpenEdge(&m_borderIn[m_remap[b]], a);
+				}
+			}
+		}
+
+		m_kind.resize(m_numVertices);
+		for (unsigned int v = 0; v < m_numVertices; v++) {
+			const unsigned int p = m_remap[v];
+			const unsigned int w = m_wedge[v];
+			unsigned char kind = KIND_LOCKED;
+			if (w == v) {
+				if (m_borderOut[p] == NONE && m_borderIn[p] == NONE) {
+					//Closed by position but open by vertex is the end of a seam
+					if (m_loopOut[v] == NONE && m_loopIn[v] == NONE)
+						kind = KIND_MANIFOLD;
+				}
+				else if (isSingle(m_borderOut[p]) && isSingle(m_borderIn[p])) {
+					kind = KIND_BORDER;
+				}
+			}
+			else if (m_wedge[w] == v && m_borderOut[p] == NONE && m_borderIn[p] == NONE) {
+				//Two vertices at one position, whose seam edges continue to the same positions on both sides
+				if (isSingle(m_loopOut[v]) && isSingle(m_loopIn[v]) && isSingle(m_loopOut[w]) && isSingle(m_loopIn[w])
+					&& m_remap[m_loopOut[v]] == m_remap[m_loopIn[w]] && m_remap[m_loopIn[v]] == m_remap[m_loopOut[w]])
+					kind = KIND_SEAM;
+			}
+			m_kind[v] = kind;
+		}
+		//Border loops were gathered per position
+		for (unsigned int v = 0; v < m_numVertices; v++) {
+			m_borderOut[v] = m_borderOut[m_remap[v]];
+			m_borderIn[v] = m_borderIn[m_remap[v]];
+		}
+	}
+
+	/// <summary>
+	/// Each triangle adds its plane to its corners, weighted by area. Border edges add a plane through the edge, perpendicular
+	/// to the triangle, so collapses that pull the outline inwards are expensive
+	/// </summary>
+	void Simplifier::buildQuadrics()
+	{
+		const float BORDER_WEIGHT = 10.0f;
+		m_quadrics.assign(m_numVertices, Quadric());
+		for (size_t i = 0; i < m_indices.size(); i += 3) {
+			const unsigned int corners[3] = { m_indices[i], m_indices[i + 1], m_indices[i + 2] };
+			const Vec3& p0 = m_positions[corners[0]];
+			Vec3 normal = Cross(m_positions[corners[1]] - p0, m_positions[corners[2]] - p0);
+			float length = Magnitude(normal);
+			if (length == 0.0f)
+				continue;
+			normal = normal / length;
+			float area = length * 0.5f;
+			for (int k = 0; k < 3; k++) {
+				addPlane(&m_quadrics[m_remap[corners[k]]], normal, -Dot(normal, p0), area);
+			}
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = corners[k];
+				unsigned int b = corners[(k + 1) % 3];
+				if (m_kind[a] != KIND_BORDER && m_kind[a] != KIND_LOCKED)
+					continue;
+				if (!isSingle(m_borderOut[a]) || m_remap[m_borderOut[a]] != m_remap[b])
+					continue;
+				Vec3 edge = m_positions[b] - m_positions[a];
+				float edgeLength = Magnitude(edge);
+				Vec3 side = Normalize(Cross(edge, normal));
+				float distance = -Dot(side, m_positions[a]);
+				addPlane(&m_quadrics[m_remap[a]], side, distance, edgeLength * edgeLength * BORDER_WEIGHT);
+				addPlane(&m_quadrics[m_remap[b]], side, distance, edgeLength * edgeLength * BORDER_WEIGHT);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Checks the kinds and, for borders and seams, that the edge runs along the border/seam.
+	/// A seam collapse also moves the vertex on the other side of the seam; that pair is returned in seamFrom/seamTo
+	/// </summary>
+	bool Simplifier::canCollapse(unsigned int from, unsigned int to, unsigned int* seamFrom, unsigned int* seamTo)const
+	{
+		const unsigned char kind = m_kind[from];
+		if (!CAN_COLLAPSE[kind][m_kind[to]])
+			return false;
+		if (kind == KIND_BORDER) {
+			return (isSingle(m_borderOut[from]) && m_remap[m_borderOut[from]] == m_remap[to])
+				|| (isSingle(m_borderIn[from]) && m_remap[m_borderIn[from]] == m_remap[to]);
+		}
+		if (kind == KIND_SEAM) {
+			unsigned int other = m_wedge[from];
+			unsigned int otherTo;
+			if (m_loopOut[from] == to)
+				otherTo = m_loopIn[other];
+			else if (m_loopIn[from] == to)
+				otherTo = m_loopOut[other];
+			else
+				return false;
+			if (!isSingle(otherTo) || otherTo == to || m_remap[otherTo] != m_remap[to])
+				return false;
+			*seamFrom = other;
+			*seamTo = otherTo;
+		}
+		return true;
+	}
+
+	//Whether moving from onto to turns any of the remaining triangles around from over. Triangles that already changed in
+	//this pass count as flipped, since their vertices are no longer where the other checks saw them
+	bool Simplifier::hasFlips(unsigned int from, unsigned int to)const
+	{
+		const unsigned int position = m_remap[from];
+		const unsigned int target = m_remap[to];
+		for (unsigned int i = m_triangles.offsets[position]; i < m_triangles.offsets[position + 1]; i++) {
+			const unsigned int* corners = &m_indices[m_triangles.data[i] * 3];
+			Vec3 before[3], after[3];
+			Vec3 shadingNormal = Vec3(0.0f);
+			bool removed = false;
+			for (int k = 0; k < 3; k++) {
+				unsigned int p = m_remap[corners[k]];
+				if (m_moved[p])
+					return true;
+				removed |= p == target;
+				unsigned int moved = p == position ? to : corners[k];
+				before[k] = m_positions[corners[k]];
+				after[k] = m_positions[moved];
+				shadingNormal += m_meshData.vertices[moved].normal;
+			}
+			if (removed)
+				continue;
+			Vec3 normalBefore = Cross(before[1] - before[0], before[2] - before[0]);
+			Vec3 normalAfter = Cross(after[1] - after[0], after[2] - after[0]);
+			//Also rejects large turns, and turns away from the vertex normals, which could otherwise add up to a flip over several passes
+			if (Dot(normalBefore, normalAfter) <= 0.25f * Magnitude(normalBefore) * Magnitude(normalAfter))
+				return true;
+			if (Dot(normalAfter, shadingNormal) < 0.0f)
+				return true;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Ranks every edge by the error of its cheaper valid direction, then collapses from the cheapest, skipping edges whose
+	/// vertices already moved or received a collapse in this pass. Returns the number of collapses
+	/// </summary>
+	size_t Simplifier::collapsePass(size_t trianglesToRemove, float errorLimit)
+	{
+		buildTriangles(&m_triangles, m_indices, m_numVertices, m_remap.data());
+
+		m_collapses.clear();
+		for (size_t i = 0; i < m_indices.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = m_indices[i + k];
+				unsigned int b = m_indices[i + (k + 1) % 3];
+				//Inner edges are in two triangles; take them from one. Border edges only have the one
+				bool border = isSingle(m_borderOut[a]) && m_remap[m_borderOut[a]] == m_remap[b];
+				if (m_remap[a] > m_remap[b] && !border)
+					continue;
+				unsigned int seamFrom, seamTo;
+				bool ab = canCollapse(a, b, &seamFrom, &seamTo);
+				bool ba = canCollapse(b, a, &seamFrom, &seamTo);
+				if (!ab && !ba)
+					continue;
+				const Quadric& qa = m_quadrics[m_remap[a]];
+				const Quadric& qb = m_quadrics[m_remap[b]];
+				float errorAB = ab ? getQuadricError(qa, qb, m_positions[b]) : FLT_MAX;
+				float errorBA = ba ? getQuadricError(qa, qb, m_positions[a]) : FLT_MAX;
+				if (errorAB <= errorBA)
+					m_collapses.push_back({ a, b, errorAB });
+				else
+					m_collapses.push_back({ b, a, errorBA });
+			}
+		}
+		if (m_collapses.empty())
+			return 0;
+		sortCollapses();
+
+		//Errors are not updated within a pass, so stop a bit past the error of the collapse that would reach the target
+		size_t goal = std::min(m_collapses.size() - 1, trianglesToRemove / 2);
+		const float passErrorLimit = m_collapses[goal].error * 1.5f;
+
+		m_collapseRemap.resize(m_numVertices);
+		for (unsigned int v = 0; v < m_numVertices; v++) {
+			m_collapseRemap[v] = v;
+		}
+		m_touched.assign(m_numVertices, 0);
+		m_moved.assign(m_numVertices, 0);
+		size_t collapses = 0;
+		size_t removed = 0;
+		for (const Collapse& collapse : m_collapses) {
+			if (removed >= trianglesToRemove)
+				break;
+			//Each collapse blocks the others around its vertices, so keep going past the limit until a fair share is done
+			if (collapse.error > errorLimit || (collapse.error > passErrorLimit && removed > trianglesToRemove / 6))
+				break;
+			const unsigned int from = collapse.from, to = collapse.to;
+			if (m_touched[m_remap[from]] || m_touched[m_remap[to]])
+				continue;
+			unsigned int seamFrom = NONE, seamTo = NONE;
+			canCollapse(from, to, &seamFrom, &seamTo);
+			if (hasFlips(from, to))
+				continue;
+			m_collapseRemap[from] = to;
+			if (m_kind[from] == KIND_SEAM)
+				m_collapseRemap[seamFrom] = seamTo;
+			addQuadric(&m_quadrics[m_remap[to]], m_quadrics[m_remap[from]]);
+			m_touched[m_remap[from]] = 1;
+			m_touched[m_remap[to]] = 1;
+			m_moved[m_remap[from]] = 1;
+			m_error = std::max(m_error, collapse.error);
+			collapses++;
+			removed += m_kind[from] == KIND_BORDER ? 1 : 2;
+		}
+		if (collapses == 0)
+			return 0;
+
+		remapLoops(&m_loopOut);
+		remapLoops(&m_loopIn);
+		remapLoops(&m_borderOut);
+		remapLoops(&m_borderIn);
+		size_t kept = 0;
+		for (size_t i = 0; i < m_indices.size(); i += 3) {
+			unsigned int a = m_collapseRemap[m_indices[i]];
+			unsigned int b = m_collapseRemap[m_indices[i + 1]];
+			unsigned int c = m_collapseRemap[m_indices[i + 2]];
+			if (m_remap[a] == m_remap[b] || m_remap[b] == m_remap[c] || m_remap[c] == m_remap[a])
+				continue;
+			m_indices[kept++] = a;
+			m_indices[kept++] = b;
+			m_indices[kept++] = c;
+		}
+		m_indices.resize(kept);
+		return collapses;
+	}
+
+	/// <summary>
+	/// Radix sort by error, 11 bits per pass. Errors are never negative, so their bits sort like unsigned integers
+	/// </summary>
+	void Simplifier::sortCollapses()
+	{
+		const int RADIX_BITS = 11;
+		const unsigned int RADIX_SIZE = 1 << RADIX_BITS;
+		m_sortBuffer.resize(m_collapses.size());
+		std::vector<unsigned int> histogram(RADIX_SIZE);
+		for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+			std::fill(histogram.begin(), histogram.end(), 0);
+			for (const Collapse& collapse : m_collapses) {
+				unsigned int bits;
+				memcpy(&bits, &collapse.error, sizeof(bits));
+				histogram[(bits >> shift) & (RADIX_SIZE - 1)]++;
+			}
+			unsigned int sum = 0;
+			for (unsigned int& count : histogram) {
+				unsigned int start = sum;
+				sum += count;
+				count = start;
+			}
+			for (const Collapse& collapse : m_collapses) {
+				unsigned int bits;
+				memcpy(&bits, &collapse.error, sizeof(bits));
+				m_sortBuffer[histogram[(bits >> shift) & (RADIX_SIZE - 1)]++] = collapse;
+			}
+			m_collapses.swap(m_sortBuffer);
+		}
+	}
+
+	//Points open edges that ended at a collapsed vertex to where it went. An edge to a vertex that collapsed onto the
+	//vertex itself continues to that vertex's next one
+	void Simplifier::remapLoops(std::vector<unsigned int>* loop)const
+	{
+		std::vector<unsigned int> previous = *loop;
+		for (unsigned int v = 0; v < m_numVertices; v++) {
+			unsigned int next = previous[v];
+			if (!isSingle(next))
+				continue;
+			unsigned int target = m_collapseRemap[next];
+			if (target == v && isSingle(previous[next]))
+				target = m_collapseRemap[previous[next]];
+			(*loop)[v] = target;
+		}
+	}
+
+	void Simplifier::run(size_t targetIndexCount, float maxError)
+	{
+		const float errorLimit = (maxError / m_scale) * (maxError / m_scale);
+		while (m_indices.size() > targetIndexCount) {
+			size_t trianglesToRemove = (m_indices.size() - targetIndexCount + 2) / 3;
+			if (collapsePass(trianglesToRemove, errorLimit) == 0)
+				break;
+		}
+	}
+
+	/// <summary>
+	/// Keeps the vertices the remaining triangles use, in their original order
+	/// </summary>
+	MeshData Simplifier::getResult()const
+	{
+		MeshData result;
+		std::vector<unsigned int> newIndex(m_numVertices, NONE);
+		for (unsigned int index : m_indices) {
+			newIndex[index] = 0;
+		}
+		for (unsigned int v = 0; v < m_numVertices; v++) {
+			if (newIndex[v] == NONE)
+				continue;
+			newIndex[v] = (unsigned int)result.vertices.size();
+			result.vertices.push_back(m_meshData.vertices[v]);
+		}
+		result.indices.resize(m_indices.size());
+		for (size_t i = 0; i < m_indices.size(); i++) {
+			result.indices[i] = newIndex[m_indices[i]];
+		}
+		if (m_meshData.has16BitIndices())
+			result.compactIndices();
+		//A subset of the vertices, so the input's bounds still hold
+		result.bounds = m_meshData.bounds;
+		result.hasBounds = m_meshData.hasBounds;
+		return result;
+	}
+
+	static bool hasValidIndices(const MeshData& meshData)
+	{
+		for (size_t i = 0; i < meshData.getNumIndices(); i++) {
+			if (meshData.getIndex(i) >= meshData.vertices.size())
+				return false;
+		}
+		return true;
+	}
+
+	MeshData simplify(const MeshData& meshData, size_t targetIndexCount, float maxError, float* errorOut)
+	{
+		if (errorOut)
+			*errorOut = 0.0f;
+		if (!hasValidIndices(meshData))
+			return meshData;
+		Simplifier simplifier(meshData);
+		simplifier.run(targetIndexCount, maxError);
+		if (errorOut)
+			*errorOut = simplifier.getError();
+		return simplifier.getResult();
+	}
+
+	void simplifyBatch(SimplifyJob* jobs, size_t count, int maxThreads)
+	{
+		auto simplifyRange = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				SimplifyJob& job = jobs[i];
+				*job.result = simplify(*job.meshData, job.targetIndexCount, job.maxError, &job.error);
+			}
+		};
+		parallelFor(count, 1, std::cref(simplifyRange), maxThreads);
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "mesh.h"
+
+namespace ew {
+	//Removes triangles with quadric error edge collapses (Garland & Heckbert) until the mesh has at most targetIndexCount indices,
+	//or until the next collapse would move the surface more than maxError (in mesh units).
+	//Edges collapse onto existing vertices, so every remaining vertex keeps its exact position, normal and UV.
+	//Vertices on UV seams and hard normal edges (split vertices at one position) only collapse along the seam, and open
+	//borders only along the border, so attribute discontinuities and outlines are kept.
+	//errorOut: largest quadric error of the collapses made (RMS distance of the kept vertices to the planes they replaced), in mesh
+	//units. It measures how far vertices moved, not how far the larger triangles sag between them, so on curved surfaces the true
+	//deviation can be a few times larger (under 5x on the spheres in tests/simplify_test); scale it up (or measure, as with getSphereError) before using it for MeshLOD::addLevel.
+	//maxError = 0 still removes vertices on flat areas. Meshes with indices past the end of vertices are returned unchanged
+	MeshData simplify(const MeshData& meshData, size_t targetIndexCount, float maxError, float* errorOut = nullptr);
+
+	//One mesh for simplifyBatch
+	struct SimplifyJob {
+		const MeshData* meshData;
+		size_t targetIndexCount;
+		float maxError;
+		MeshData* result;
+		float error; //Written by simplifyBatch
+	};
+	//Simplifies independent meshes on the job threads, one mesh per job (maxThreads as in procGen)
+	void simplifyBatch(SimplifyJob* jobs, size_t count, int maxThreads = 0);
+}
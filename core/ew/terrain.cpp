@@ -0,0 +1,338 @@
+#include "terrain.h"
+#include "procGen.h"
+#include "vertexFormat.h"
+#include "jobs.h"
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+namespace ew {
+	static uint64_t chunkKey(int x, int z)
+	{
+		return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z;
+	}
+
+	/// <summary>
+	/// Rewrites triangles through remap and drops the ones that became degenerate
+	/// </summary>
+	/// <returns>Number of indices kept</returns>
+	template<typename Index>
+	static size_t remapTriangles(Index* indices, size_t numIndices, const unsigned int* remap)
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < numIndices; i += 3) {
+			const unsigned int a = remap[indices[i]];
+			const unsigned int b = remap[indices[i + 1]];
+			const unsigned int c = remap[indices[i + 2]];
+			if (a == b || b == c || c == a)
+				continue;
+			indices[count++] = a;
+			indices[count++] = b;
+			indices[count++] = c;
+		}
+		return count;
+	}
+
+	Terrain::Terrain(const TerrainSettings& settings)
+		:m_settings(settings)
+	{
+		int resolution = 1;
+		while (resolution < m_settings.chunkResolution) {
+			resolution *= 2;
+		}
+		int maxLods = 1;
+		while ((resolution >> maxLods) >= 1) {
+			maxLods++;
+		}
+		m_settings.chunkResolution = resolution;
+		m_settings.numLods = std::min(std::max(m_settings.numLods, 1), maxLods);
+		m_settings.maxBuildsPerUpdate = std::max(m_settings.maxBuildsPerUpdate, 1);
+		if (m_settings.vertexFormat == VertexFormat::QUANTIZED)
+			m_settings.vertexFormat = VertexFormat::PACKED;
+		m_cellSize = m_settings.chunkSize / resolution;
+	}
+	Terrain::~Terrain()
+	{
+		clear();
+	}
+
+	void Terrain::update(const ew::Vec3& cameraPosition)
+	{
+		if (m_pending.empty() && !m_planChanged)
+			plan(cameraPosition);
+		buildPending();
+		if (m_pending.empty() && m_planChanged)
+			swapChunks();
+	}
+	size_t Terrain::draw()const
+	{
+		for (const Chunk& chunk : m_chunks) {
+			chunk.mesh.draw();
+		}
+		return m_chunks.size();
+	}
+	size_t Terrain::draw(const Frustum& frustum)const
+	{
+		size_t numDrawn = 0;
+		for (const Chunk& chunk : m_chunks) {
+			if (!frustum.intersects(chunk.bounds))
+				continue;
+			chunk.mesh.draw();
+			numDrawn++;
+		}
+		return numDrawn;
+	}
+	void Terrain::clear()
+	{
+		for (Chunk& chunk : m_chunks) {
+			chunk.mesh.unload();
+		}
+		//Chunks carried over from m_chunks are only copied in swapChunks(), so these are all built ones (or not loaded yet)
+		for (Chunk& chunk : m_next) {
+			chunk.mesh.unload();
+		}
+		m_chunks.clear();
+		m_next.clear();
+		m_reuse.clear();
+		m_pending.clear();
+		m_planChanged = false;
+		m_memoryUsage = 0;
+		m_stagedBytes = 0;
+	}
+
+	float Terrain::getHeight(float x, float z)const
+	{
+		return m_settings.heightScale * FractalNoise(x, z, m_settings.noise);
+	}
+
+	/// <summary>
+	/// Grid topology comes from createPlane. Positions are recomputed from the chunk's place in the LOD 0 grid, and normals come from
+	/// central differences of the heights, which are sampled one cell past the chunk's edges so neighbors of the same LOD get the same normals.
+	/// To match a coarser neighbor, the edge vertices it doesn't have are collapsed onto the previous one it does have. The
+	/// collapsed vertices stay in the vertex buffer unused
+	/// </summary>
+	void Terrain::buildChunk(int x, int z, int lod, const int edgeLods[4], MeshData* meshData)const
+	{
+		lod = std::min(std::max(lod, 0), m_settings.numLods - 1);
+		const int n = m_settings.chunkResolution >> lod;
+		const int step = 1 << lod; //LOD 0 cells per grid cell
+		const float spacing = m_cellSize * step;
+		createPlane(m_settings.chunkSize, m_settings.chunkSize, n, meshData, 1);
+
+		//Padded row/column r is grid row/column r - 1. Rows run toward -z, like createPlane's.
+		//Rows are rounded up to a multiple of 4 so FractalNoise has no scalar remainder: every sample then goes through the same
+		//code, and an edge shared with a neighbor gets bit identical heights even where the compiler contracts multiply-adds into
+		//FMAs differently for the scalar and SIMD paths (e.g. AArch64's default -ffp-contract=fast)
+		const int rows = n + 3;
+		const int columns = (rows + 3) & ~3;
+		const int64_t originX = (int64_t)x * m_settings.chunkResolution;
+		const int64_t originZ = (int64_t)z * m_settings.chunkResolution;
+		std::vector<float> heights(rows * columns);
+		std::vector<float> xs(columns);
+		std::vector<float> zs(columns);
+		for (int c = 0; c < columns; c++) {
+			xs[c] = (float)(originX + (int64_t)(c - 1) * step) * m_cellSize;
+		}
+		for (int r = 0; r < rows; r++) {
+			std::fill(zs.begin(), zs.end(), (float)(originZ + (int64_t)(n + 1 - r) * step) * m_cellSize);
+			FractalNoise(xs.data(), zs.data(), columns, m_settings.noise, &heights[r * columns]);
+		}
+		for (float& height : heights) {
+			height *= m_settings.heightScale;
+		}
+
+		for (int row = 0; row <= n; row++) {
+			const float worldZ = (float)(originZ + (int64_t)(n - row) * step) * m_cellSize;
+			for (int col = 0; col <= n; col++) {
+				Vertex& v = meshData->vertices[row * (n + 1) + col];
+				const float* h = &heights[(row + 1) * columns + col + 1];
+				v.pos = Vec3(xs[col + 1], h[0], worldZ);
+				//+x is the next column, +z the previous row
+				const float dx = (h[1] - h[-1]) / (2.0f * spacing);
+				const float dz = (h[-columns] - h[columns]) / (2.0f * spacing);
+				v.normal = Normalize(Vec3(-dx, 1.0f, -dz));
+				//Continuous across chunks, repeating once per chunk like createPlane's
+				v.uv = Vec2(v.pos.x / m_settings.chunkSize, -v.pos.z / m_settings.chunkSize);
+			}
+		}
+
+		std::vector<unsigned int> remap;
+		for (int side = 0; side < 4; side++) {
+			const int edgeLod = std::min(edgeLods[side], m_settings.numLods - 1);
+			if (edgeLod <= lod)
+				continue;
+			if (remap.empty()) {
+				remap.resize(meshData->vertices.size());
+				for (size_t i = 0; i < remap.size(); i++) {
+					remap[i] = (unsigned int)i;
+				}
+			}
+			const int ratio = 1 << (edgeLod - lod);
+			for (int i = 0; i <= n; i++) {
+				const int keep = i - i % ratio;
+				//-x is column 0, +x column n, -z row n, +z row 0
+				const unsigned int from[4] = { (unsigned int)(i * (n + 1)), (unsigned int)(i * (n + 1) + n), (unsigned int)(n * (n + 1) + i), (unsigned int)i };
+				const unsigned int to[4] = { (unsigned int)(keep * (n + 1)), (unsigned int)(keep * (n + 1) + n), (unsigned int)(n * (n + 1) + keep), (unsigned int)keep };
+				remap[from[side]] = to[side];
+			}
+		}
+		if (!remap.empty()) {
+			if (meshData->has16BitIndices())
+				meshData->indices16.resize(remapTriangles(meshData->indices16.data(), meshData->indices16.size(), remap.data()));
+			else
+				meshData->indices.resize(remapTriangles(meshData->indices.data(), meshData->indices.size(), remap.data()));
+		}
+		meshData->updateBounds(1);
+	}
+
+	int Terrain::getLod(float distance)const
+	{
+		int lod = 0;
+		float limit = m_settings.lodDistance;
+		while (distance >= limit && lod < m_settings.numLods - 1) {
+			lod++;
+			limit *= 2.0f;
+		}
+		return lod;
+	}
+	/// <summary>
+	/// Before stitching, which only removes triangles
+	/// </summary>
+	size_t Terrain::getChunkBytes(int lod)const
+	{
+		const MeshSize size = getPlaneSize(m_settings.chunkResolution >> lod);
+		const size_t vertexSize = m_settings.vertexFormat == VertexFormat::PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+		const size_t indexSize = size.numVertices <= MAX_16BIT_VERTICES ? sizeof(unsigned short) : sizeof(unsigned int);
+		return size.numVertices * vertexSize + size.numIndices * indexSize;
+	}
+
+	/// <summary>
+	/// Chunks within viewDistance of the camera are added nearest first until the next one would go over the budget, so the budget
+	/// shortens the view distance evenly. Distance is measured to the chunk's square, widened to +-heightScale vertically.
+	/// Chunks of the drawn set are kept if their LOD and their edges' LODs are unchanged
+	/// </summary>
+	void Terrain::plan(const ew::Vec3& cameraPosition)
+	{
+		struct Candidate {
+			int x, z;
+			float distance;
+		};
+		std::vector<Candidate> candidates;
+		const float size = m_settings.chunkSize;
+		const float viewDistance = m_settings.viewDistance;
+		const int minX = (int)floorf((cameraPosition.x - viewDistance) / size);
+		const int maxX = (int)floorf((cameraPosition.x + viewDistance) / size);
+		const int minZ = (int)floorf((cameraPosition.z - viewDistance) / size);
+		const int maxZ = (int)floorf((cameraPosition.z + viewDistance) / size);
+		const float dy = std::max(fabsf(cameraPosition.y) - m_settings.heightScale, 0.0f);
+		for (int z = minZ; z <= maxZ; z++) {
+			const float dz = std::max(std::max(z * size - cameraPosition.z, cameraPosition.z - (z + 1) * size), 0.0f);
+			for (int x = minX; x <= maxX; x++) {
+				const float dx = std::max(std::max(x * size - cameraPosition.x, cameraPosition.x - (x + 1) * size), 0.0f);
+				const float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+				if (distance <= viewDistance)
+					candidates.push_back({ x, z, distance });
+			}
+		}
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			if (a.distance != b.distance)
+				return a.distance < b.distance;
+			return a.z != b.z ? a.z < b.z : a.x < b.x;
+		});
+
+		m_next.clear();
+		std::unordered_map<uint64_t, int> lods;
+		size_t bytes = 0;
+		for (const Candidate& candidate : candidates) {
+			const int lod = getLod(candidate.distance);
+			const size_t chunkBytes = getChunkBytes(lod);
+			if (bytes + chunkBytes > m_settings.budgetBytes)
+				break;
+			bytes += chunkBytes;
+			Chunk chunk = {};
+			chunk.x = candidate.x;
+			chunk.z = candidate.z;
+			chunk.lod = lod;
+			m_next.push_back(chunk);
+			lods[chunkKey(candidate.x, candidate.z)] = lod;
+		}
+
+		std::unordered_map<uint64_t, size_t> drawn;
+		for (size_t i = 0; i < m_chunks.size(); i++) {
+			drawn[chunkKey(m_chunks[i].x, m_chunks[i].z)] = i;
+		}
+		const int neighbors[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+		m_reuse.assign(m_next.size(), -1);
+		m_pending.clear();
+		size_t numReused = 0;
+		for (size_t i = 0; i < m_next.size(); i++) {
+			Chunk& chunk = m_next[i];
+			for (int side = 0; side < 4; side++) {
+				auto neighbor = lods.find(chunkKey(chunk.x + neighbors[side][0], chunk.z + neighbors[side][1]));
+				chunk.edgeLods[side] = neighbor != lods.end() ? std::max(neighbor->second, chunk.lod) : chunk.lod;
+			}
+			auto current = drawn.find(chunkKey(chunk.x, chunk.z));
+			if (current != drawn.end()) {
+				const Chunk& other = m_chunks[current->second];
+				if (other.lod == chunk.lod && std::equal(other.edgeLods, other.edgeLods + 4, chunk.edgeLods)) {
+					m_reuse[i] = (int)current->second;
+					numReused++;
+					continue;
+				}
+			}
+			m_pending.push_back(i);
+		}
+		m_planChanged = !m_pending.empty() || numReused != m_chunks.size();
+	}
+
+	void Terrain::buildPending()
+	{
+		const size_t count = std::min(m_pending.size(), (size_t)m_settings.maxBuildsPerUpdate);
+		if (count == 0)
+			return;
+		if (m_buildData.size() < count)
+			m_buildData.resize(count);
+		auto build = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const Chunk& chunk = m_next[m_pending[i]];
+				buildChunk(chunk.x, chunk.z, chunk.lod, chunk.edgeLods, &m_buildData[i]);
+			}
+		};
+		parallelFor(count, 1, std::cref(build));
+
+		const size_t vertexSize = m_settings.vertexFormat == VertexFormat::PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+		for (size_t i = 0; i < count; i++) {
+			Chunk& chunk = m_next[m_pending[i]];
+			chunk.mesh.load(m_buildData[i], m_settings.vertexFormat);
+			chunk.bounds = chunk.mesh.getBounds().box;
+			const size_t indexSize = chunk.mesh.has16BitIndices() ? sizeof(unsigned short) : sizeof(unsigned int);
+			chunk.bytes = chunk.mesh.getNumVertices() * vertexSize + chunk.mesh.getNumIndices() * indexSize;
+			m_stagedBytes += chunk.bytes;
+		}
+		m_pending.erase(m_pending.begin(), m_pending.begin() + count);
+	}
+
+	void Terrain::swapChunks()
+	{
+		std::vector<bool> kept(m_chunks.size(), false);
+		for (size_t i = 0; i < m_next.size(); i++) {
+			if (m_reuse[i] < 0)
+				continue;
+			m_next[i] = m_chunks[m_reuse[i]];
+			kept[m_reuse[i]] = true;
+		}
+		for (size_t i = 0; i < m_chunks.size(); i++) {
+			if (!kept[i])
+				m_chunks[i].mesh.unload();
+		}
+		m_chunks.swap(m_next);
+		m_next.clear();
+		m_reuse.clear();
+		m_memoryUsage = 0;
+		for (const Chunk& chunk : m_chunks) {
+			m_memoryUsage += chunk.bytes;
+		}
+		m_stagedBytes = 0;
+		m_planChanged = false;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "frustum.h"
+#include "ewMath/noise.h"
+
+namespace ew {
+	struct TerrainSettings {
+		float chunkSize = 256.0f; //World units per chunk side
+		int chunkResolution = 64; //Grid cells per chunk side at LOD 0. Rounded up to a power of 2
+		int numLods = 4; //Each level halves the resolution of the one before. Limited to what chunkResolution allows
+		float lodDistance = 384.0f; //Chunks closer than this use LOD 0. Each following level starts at twice the distance
+		float viewDistance = 2048.0f; //Chunks farther than this are not loaded
+		float heightScale = 300.0f; //Heights are FractalNoise times this
+		FractalNoiseSettings noise = { 6, 1.0f / 2048.0f };
+		size_t budgetBytes = 64 * 1024 * 1024; //GPU memory (vertex + index buffers) for the chunks. The farthest chunks are left out to fit
+		int maxBuildsPerUpdate = 16; //Chunks built per update(), which bounds the time one frame spends on streaming
+		VertexFormat vertexFormat = VertexFormat::PACKED; //FLOAT or PACKED. QUANTIZED would need a model matrix per chunk and is uploaded as PACKED
+	};
+
+	//Height field terrain split into square chunks, which stream in and out around the camera.
+	//Chunk (x, z) covers [x, x + 1] * chunkSize on the x and z axes. Each chunk is a createPlane grid whose vertices are moved
+	//to world space and lifted to heightScale * FractalNoise(x, z). Chunks farther from the camera use coarser grids (LODs).
+	//Vertices are placed from integer grid coordinates, so vertices that neighboring chunks share have identical positions.
+	//Where a chunk borders a coarser one, its extra edge vertices are collapsed onto the coarser edge, so there are no cracks
+	//or T-junctions between LODs.
+	//Needs a current OpenGL context for update(), draw() and destruction
+	class Terrain {
+	public:
+		Terrain(const TerrainSettings& settings = TerrainSettings());
+		~Terrain();
+		Terrain(const Terrain&) = delete;
+		Terrain& operator=(const Terrain&) = delete;
+
+		//Plans which chunks to show at which LOD around cameraPosition, then builds up to maxBuildsPerUpdate of the missing
+		//ones on the job threads (one chunk per job) and uploads them. The drawn set only changes once every chunk of a plan
+		//is built, so neighbors always match; until then the previous set is drawn. A new plan is made once the last one is done.
+		//Chunks from both sets are resident during the switch, so memory can briefly go over budgetBytes
+		void update(const ew::Vec3& cameraPosition);
+		//Draws the chunks, or only those whose bounds are inside frustum. Vertices are in world space, so draw with an identity
+		//model matrix. Returns the number of chunks drawn
+		size_t draw()const;
+		size_t draw(const Frustum& frustum)const;
+		//Unloads every chunk and drops the plan in progress
+		void clear();
+
+		//Height of the terrain at (x, z). Exact at grid vertices; between them the triangles interpolate it
+		float getHeight(float x, float z)const;
+		//Builds chunk (x, z) on the calling thread. edgeLods are the LODs its -x, +x, -z and +z edges must match (the
+		//neighbors' LODs, or lod where the neighbor is finer or missing)
+		void buildChunk(int x, int z, int lod, const int edgeLods[4], MeshData* meshData)const;
+
+		inline const TerrainSettings& getSettings()const { return m_settings; }
+		inline size_t getNumChunks()const { return m_chunks.size(); }
+		//Chunks of the current plan still to build
+		inline size_t getNumPendingBuilds()const { return m_pending.size(); }
+		//GPU memory of the drawn chunks and of those built for the next set
+		inline size_t getMemoryUsage()const { return m_memoryUsage + m_stagedBytes; }
+	private:
+		struct Chunk {
+			int x, z;
+			int lod;
+			int edgeLods[4];
+			Mesh mesh;
+			AABB bounds;
+			size_t bytes;
+		};
+		int getLod(float distance)const;
+		size_t getChunkBytes(int lod)const;
+		void plan(const ew::Vec3& cameraPosition);
+		void buildPending();
+		void swapChunks();
+
+		TerrainSettings m_settings; //After rounding and clamping
+		float m_cellSize; //World units per LOD 0 grid cell
+		std::vector<Chunk> m_chunks; //Drawn
+		std::vector<Chunk> m_next; //The plan in progress, filled as chunks are built or carried over
+		std::vector<int> m_reuse; //Per chunk of m_next, the chunk of m_chunks it keeps (-1 if built)
+		std::vector<size_t> m_pending; //Chunks of m_next still to build, nearest first
+		bool m_planChanged = false;
+		std::vector<MeshData> m_buildData; //Reused between batches to keep their capacity
+		size_t m_memoryUsage = 0;
+		size_t m_stagedBytes = 0;
+	};
+}
@@ -2,17 +2,51 @@
 #include "ewMath/ewMath.h"
 #include "ewMath/transformations.h"
 namespace ew {
-	struct Transform {
-		ew::Vec3 position = ew::Vec3(0.0f, 0.0f, 0.0f);
-		ew::Vec3 rotation = ew::Vec3(0.0f, 0.0f, 0.0f); //Euler angles (Degrees)
-		ew::Vec3 scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+	//Position, rotation and scale of an object.
+	//The model matrix is cached and only rebuilt after one of the setters has been called, so static objects cost nothing per frame.
+	class Transform {
+	public:
+		inline const ew::Vec3& getPosition()const { return m_position; }
+		inline const ew::Vec3& getRotation()const { return m_rotation; }
+		inline const ew::Vec3& getScale()const { return m_scale; }
+		inline void setPosition(const ew::Vec3& position) { m_position = position; m_dirty = true; }
+		inline void setRotation(const ew::Vec3& rotation) { m_rotation = rotation; m_useOrientation = false; m_dirty = true; }
+		inline void setScale(const ew::Vec3& scale) { m_scale = scale; m_dirty = true; }
 
-		ew::Mat4 getModelMatrix() const {
-			return ew::Translate(position)
-				* ew::RotateY(ew::Radians(rotation.y))
-				* ew::RotateX(ew::Radians(rotation.x))
-				* ew::RotateZ(ew::Radians(rotation.z))
-				* ew::Scale(scale);
+		//Quaternion rotation. Once set, the model matrix is built from the quaternion (no trig) until setRotation is called again.
+		//getRotation() keeps returning the last Euler angles given to setRotation.
+		inline void setOrientation(const ew::Quat& orientation) { m_orientation = orientation; m_useOrientation = true; m_dirty = true; }
+		//Current rotation as a unit quaternion, converted from the Euler angles when no quaternion has been set
+		inline ew::Quat getOrientation()const { return m_useOrientation ? m_orientation : ew::EulerToQuat(m_rotation * ew::DEG2RAD); }
+		inline bool usesOrientation()const { return m_useOrientation; }
+		//Applies rotation after the current one (in world space)
+		inline void rotate(const ew::Quat& rotation) { setOrientation(ew::Normalize(rotation * getOrientation())); }
+
+		//Not safe to call on the same Transform from multiple threads while it is dirty
+		const ew::Mat4& getModelMatrix() const {
+			if (m_dirty) {
+				m_modelMatrix = m_useOrientation
+					? ew::TRS(m_position, m_orientation, m_scale)
+					: ew::TRS(m_position, m_rotation * ew::DEG2RAD, m_scale);
+				m_dirty = false;
+			}
+			return m_modelMatrix;
+		}
+		//Model matrix without the constant bottom row, for uploading as a mat3x4
+		inline ew::Affine3x4 getAffineMatrix() const {
+			return ew::Affine3x4(getModelMatrix());
+		}
+		//Inverse transpose of the model matrix's 3x3 part, for transforming normals. Upload as a mat3 instead of calling inverse() per vertex
+		inline ew::Mat3 getNormalMatrix() const {
+			return ew::NormalMatrix(getModelMatrix());
 		}
+	private:
+		ew::Vec3 m_position = ew::Vec3(0.0f, 0.0f, 0.0f);
+		ew::Vec3 m_rotation = ew::Vec3(0.0f, 0.0f, 0.0f); //Euler angles (Degrees)
+		ew::Vec3 m_scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+		ew::Quat m_orientation;
+		bool m_useOrientation = false;
+		mutable ew::Mat4 m_modelMatrix;
+		mutable bool m_dirty = true;
 	};
 }
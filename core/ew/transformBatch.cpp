@@ -0,0 +1,333 @@
+#include "transformBatch.h"
+#include "jobs.h"
+
+namespace ew {
+	void TransformBatch::resize(size_t count)
+	{
+		positionX.resize(count, 0.0f);
+		positionY.resize(count, 0.0f);
+		positionZ.resize(count, 0.0f);
+		rotationX.resize(count, 0.0f);
+		rotationY.resize(count, 0.0f);
+		rotationZ.resize(count, 0.0f);
+		scaleX.resize(count, 1.0f);
+		scaleY.resize(count, 1.0f);
+		scaleZ.resize(count, 1.0f);
+		orientationX.resize(count, 0.0f);
+		orientationY.resize(count, 0.0f);
+		orientationZ.resize(count, 0.0f);
+		orientationW.resize(count, 1.0f);
+	}
+	void TransformBatch::clear()
+	{
+		resize(0);
+	}
+	void TransformBatch::add(const Transform& transform)
+	{
+		resize(size() + 1);
+		set(size() - 1, transform);
+	}
+	void TransformBatch::set(size_t i, const Transform& transform)
+	{
+		const ew::Vec3& position = transform.getPosition();
+		const ew::Vec3& rotation = transform.getRotation();
+		const ew::Vec3& scale = transform.getScale();
+		positionX[i] = position.x;
+		positionY[i] = position.y;
+		positionZ[i] = position.z;
+		rotationX[i] = rotation.x;
+		rotationY[i] = rotation.y;
+		rotationZ[i] = rotation.z;
+		scaleX[i] = scale.x;
+		scaleY[i] = scale.y;
+		scaleZ[i] = scale.z;
+		const ew::Quat orientation = transform.getOrientation();
+		orientationX[i] = orientation.x;
+		orientationY[i] = orientation.y;
+		orientationZ[i] = orientation.z;
+		orientationW[i] = orientation.w;
+	}
+	Transform TransformBatch::get(size_t i) const
+	{
+		Transform transform;
+		transform.setPosition(ew::Vec3(positionX[i], positionY[i], positionZ[i]));
+		transform.setRotation(ew::Vec3(rotationX[i], rotationY[i], rotationZ[i]));
+		transform.setScale(ew::Vec3(scaleX[i], scaleY[i], scaleZ[i]));
+		if (useOrientation) {
+			transform.setOrientation(ew::Quat(orientationX[i], orientationY[i], orientationZ[i], orientationW[i]));
+		}
+		return transform;
+	}
+
+	static Mat4 composeModelMatrix(const TransformBatch& batch, size_t i) {
+		const ew::Vec3 position = ew::Vec3(batch.positionX[i], batch.positionY[i], batch.positionZ[i]);
+		const ew::Vec3 scale = ew::Vec3(batch.scaleX[i], batch.scaleY[i], batch.scaleZ[i]);
+		if (batch.useOrientation) {
+			const ew::Quat orientation = ew::Quat(batch.orientationX[i], batch.orientationY[i], batch.orientationZ[i], batch.orientationW[i]);
+			return ew::TRS(position, orientation, scale);
+		}
+		const ew::Vec3 rotation = ew::Vec3(batch.rotationX[i], batch.rotationY[i], batch.rotationZ[i]) * ew::DEG2RAD;
+		if (batch.fastTrig) {
+			ew::Vec3 sinR, cosR;
+			ew::FastSinCos(rotation.x, &sinR.x, &cosR.x);
+			ew::FastSinCos(rotation.y, &sinR.y, &cosR.y);
+			ew::FastSinCos(rotation.z, &sinR.z, &cosR.z);
+			return ew::TRSSinCos(position, sinR, cosR, scale);
+		}
+		return ew::TRS(position, rotation, scale);
+	}
+
+	/// <summary>
+	/// Normal matrix of transform i given its model matrix m. For rotation * scale the inverse transpose is rotation / scale,
+	/// which is each column of m divided by its squared scale. Zero scale gives non-finite values.
+	/// </summary>
+	static Mat3 composeNormalMatrix(const TransformBatch& batch, size_t i, const Mat4& m) {
+		const float invX = 1.0f / (batch.scaleX[i] * batch.scaleX[i]);
+		const float invY = 1.0f / (batch.scaleY[i] * batch.scaleY[i]);
+		const float invZ = 1.0f / (batch.scaleZ[i] * batch.scaleZ[i]);
+		return Mat3(m[0].toVec3() * invX, m[1].toVec3() * invY, m[2].toVec3() * invZ);
+	}
+
+#if defined(EW_SIMD)
+	/// <summary>
+	/// Rotation part of the model matrices for 4 consecutive quaternion transforms, one transform per lane. No trig.
+	/// </summary>
+	static void composeQuatLanes(const TransformBatch& batch, size_t i, simd::float4 rows[3][4]) {
+		using namespace ew::simd;
+		const float4 x = Load(&batch.orientationX[i]);
+		const float4 y = Load(&batch.orientationY[i]);
+		const float4 z = Load(&batch.orientationZ[i]);
+		const float4 w = Load(&batch.orientationW[i]);
+		const float4 one = Splat(1.0f);
+		const float4 two = Splat(2.0f);
+		const float4 xx = Mul(x, x), yy = Mul(y, y), zz = Mul(z, z);
+		const float4 xy = Mul(x, y), xz = Mul(x, z), yz = Mul(y, z);
+		const float4 wx = Mul(w, x), wy = Mul(w, y), wz = Mul(w, z);
+		rows[0][0] = Sub(one, Mul(two, Add(yy, zz)));
+		rows[1][0] = Mul(two, Add(xy, wz));
+		rows[2][0] = Mul(two, Sub(xz, wy));
+		rows[0][1] = Mul(two, Sub(xy, wz));
+		rows[1][1] = Sub(one, Mul(two, Add(xx, zz)));
+		rows[2][1] = Mul(two, Add(yz, wx));
+		rows[0][2] = Mul(two, Add(xz, wy));
+		rows[1][2] = Mul(two, Sub(yz, wx));
+		rows[2][2] = Sub(one, Mul(two, Add(xx, yy)));
+	}
+
+	/// <summary>
+	/// Rotation part of the model matrices for 4 consecutive Euler transforms, one transform per lane.
+	/// Uses the same closed form as ew::TRS. With fastTrig the sines/cosines are computed 4 at a time with ew::FastSinCos.
+	/// </summary>
+	static void composeEulerLanes(const TransformBatch& batch, size_t i, simd::float4 rows[3][4]) {
+		using namespace ew::simd;
+		float4 sx, cx, sy, cy, sz, cz;
+		if (batch.fastTrig) {
+			//Same radians as composeModelMatrix (degrees * DEG2RAD), so lanes match the scalar tail
+			const float4 toRadians = Splat(ew::DEG2RAD);
+			ew::FastSinCos(Mul(Load(&batch.rotationX[i]), toRadians), &sx, &cx);
+			ew::FastSinCos(Mul(Load(&batch.rotationY[i]), toRadians), &sy, &cy);
+			ew::FastSinCos(Mul(Load(&batch.rotationZ[i]), toRadians), &sz, &cz);
+		}
+		else {
+			//Trig for the 4 transforms
+			float sinX[4], cosX[4], sinY[4], cosY[4], sinZ[4], cosZ[4];
+			for (int k = 0; k < 4; k++)
+			{
+				const float rx = ew::Radians(batch.rotationX[i + k]);
+				const float ry = ew::Radians(batch.rotationY[i + k]);
+				const float rz = ew::Radians(batch.rotationZ[i + k]);
+				sinX[k] = sinf(rx); cosX[k] = cosf(rx);
+				sinY[k] = sinf(ry); cosY[k] = cosf(ry);
+				sinZ[k] = sinf(rz); cosZ[k] = cosf(rz);
+			}
+			sx = Load(sinX); cx = Load(cosX);
+			sy = Load(sinY); cy = Load(cosY);
+			sz = Load(sinZ); cz = Load(cosZ);
+		}
+		const float4 sysx = Mul(sy, sx);
+		const float4 cysx = Mul(cy, sx);
+		rows[0][0] = Add(Mul(cy, cz), Mul(sysx, sz));
+		rows[1][0] = Mul(cx, sz);
+		rows[2][0] = Sub(Mul(cysx, sz), Mul(sy, cz));
+		rows[0][1] = Sub(Mul(sysx, cz), Mul(cy, sz));
+		rows[1][1] = Mul(cx, cz);
+		rows[2][1] = Add(Mul(sy, sz), Mul(cysx, cz));
+		rows[0][2] = Mul(sy, cx);
+		rows[1][2] = Sub(Splat(0.0f), sx);
+		rows[2][2] = Mul(cy, cx);
+	}
+
+	/// <summary>
+	/// Top 3 rows of the model matrices for 4 consecutive transforms, one transform per SIMD lane.
+	/// rows[r][c] holds element (row r, column c).
+	/// </summary>
+	static void composeLanes(const TransformBatch& batch, size_t i, simd::float4 rows[3][4]) {
+		using namespace ew::simd;
+		if (batch.useOrientation)
+			composeQuatLanes(batch, i, rows);
+		else
+			composeEulerLanes(batch, i, rows);
+		const float4 scale[3] = { Load(&batch.scaleX[i]), Load(&batch.scaleY[i]), Load(&batch.scaleZ[i]) };
+		for (int c = 0; c < 3; c++)
+		{
+			rows[0][c] = Mul(rows[0][c], scale[c]);
+			rows[1][c] = Mul(rows[1][c], scale[c]);
+			rows[2][c] = Mul(rows[2][c], scale[c]);
+		}
+		rows[0][3] = Load(&batch.positionX[i]);
+		rows[1][3] = Load(&batch.positionY[i]);
+		rows[2][3] = Load(&batch.positionZ[i]);
+	}
+
+	/// <summary>
+	/// Writes the normal matrices of 4 consecutive transforms from their composed rows. Same formula as composeNormalMatrix.
+	/// </summary>
+	static void storeNormalLanes(const TransformBatch& batch, size_t i, const simd::float4 rows[3][4], Mat3* out) {
+		using namespace ew::simd;
+		const float4 one = Splat(1.0f);
+		const float4 sx = Load(&batch.scaleX[i]);
+		const float4 sy = Load(&batch.scaleY[i]);
+		const float4 sz = Load(&batch.scaleZ[i]);
+		const float4 invScale[3] = { Div(one, Mul(sx, sx)), Div(one, Mul(sy, sy)), Div(one, Mul(sz, sz)) };
+		//Mat3 is 9 floats, so lanes are spilled and scattered instead of transposed
+		float lanes[3][3][4];
+		for (int c = 0; c < 3; c++)
+		{
+			for (int r = 0; r < 3; r++)
+			{
+				Store(lanes[c][r], Mul(rows[r][c], invScale[c]));
+			}
+		}
+		for (int k = 0; k < 4; k++)
+		{
+			Mat3& m = out[i + k];
+			for (int c = 0; c < 3; c++)
+			{
+				m[c] = Vec3(lanes[c][0][k], lanes[c][1][k], lanes[c][2][k]);
+			}
+		}
+	}
+#endif
+
+	/// <summary>
+	/// Computes model matrices for [begin, end), 4 at a time when SIMD is available.
+	/// Lanes are transposed so each matrix is written out as four contiguous columns.
+	/// Normal matrices are written to normals as well unless it is null.
+	/// </summary>
+	static void composeModelMatrices(const TransformBatch& batch, Mat4* out, Mat3* normals, size_t begin, size_t end) {
+		size_t i = begin;
+#if defined(EW_SIMD)
+		using namespace ew::simd;
+		const float4 zero = Splat(0.0f);
+		for (; i + 4 <= end; i += 4)
+		{
+			float4 rows[3][4];
+			composeLanes(batch, i, rows);
+			if (normals)
+				storeNormalLanes(batch, i, rows, normals);
+			//After each transpose register k holds that column of transform i+k
+			float4 columns[4][4];
+			for (int c = 0; c < 4; c++)
+			{
+				columns[c][0] = rows[0][c];
+				columns[c][1] = rows[1][c];
+				columns[c][2] = rows[2][c];
+				columns[c][3] = c == 3 ? Splat(1.0f) : zero;
+				Transpose(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+			}
+			for (int k = 0; k < 4; k++)
+			{
+				Mat4& m = out[i + k];
+				Store(&m[0][0], columns[0][k]);
+				Store(&m[1][0], columns[1][k]);
+				Store(&m[2][0], columns[2][k]);
+				Store(&m[3][0], columns[3][k]);
+			}
+		}
+#endif
+		for (; i < end; i++)
+		{
+			out[i] = composeModelMatrix(batch, i);
+			if (normals)
+				normals[i] = composeNormalMatrix(batch, i, out[i]);
+		}
+	}
+
+	/// <summary>
+	/// Same as composeModelMatrices but writes 3 rows per transform. Transposing the 4 columns of a row gives that row for each lane.
+	/// </summary>
+	static void composeAffineMatrices(const TransformBatch& batch, Affine3x4* out, Mat3* normals, size_t begin, size_t end) {
+		size_t i = begin;
+#if defined(EW_SIMD)
+		using namespace ew::simd;
+		for (; i + 4 <= end; i += 4)
+		{
+			float4 rows[3][4];
+			composeLanes(batch, i, rows);
+			if (normals)
+				storeNormalLanes(batch, i, rows, normals);
+			for (int r = 0; r < 3; r++)
+			{
+				Transpose(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+				for (int k = 0; k < 4; k++)
+				{
+					Store(&out[i + k][r].x, rows[r][k]);
+				}
+			}
+		}
+#endif
+		for (; i < end; i++)
+		{
+			const Mat4 m = composeModelMatrix(batch, i);
+			out[i] = Affine3x4(m);
+			if (normals)
+				normals[i] = composeNormalMatrix(batch, i, m);
+		}
+	}
+
+	void TransformBatch::computeModelMatrices(Mat4* out, int maxThreads) const
+	{
+		computeModelMatrices(out, nullptr, maxThreads);
+	}
+	void TransformBatch::computeModelMatrices(Mat4* out, Mat3* normalsOut, int maxThreads) const
+	{
+		//Large enough chunks that the per-range overhead is negligible
+		const size_t minChunk = 2048;
+		ew::parallelFor(size(), minChunk, [this, out, normalsOut](size_t begin, size_t end) {
+			composeModelMatrices(*this, out, normalsOut, begin, end);
+		}, maxThreads);
+	}
+	void TransformBatch::computeModelMatrices(std::vector<Mat4>& out, int maxThreads) const
+	{
+		out.resize(size());
+		computeModelMatrices(out.data(), maxThreads);
+	}
+	void TransformBatch::computeModelMatrices(std::vector<Mat4>& out, std::vector<Mat3>& normalsOut, int maxThreads) const
+	{
+		out.resize(size());
+		normalsOut.resize(size());
+		computeModelMatrices(out.data(), normalsOut.data(), maxThreads);
+	}
+	void TransformBatch::computeAffineMatrices(Affine3x4* out, int maxThreads) const
+	{
+		computeAffineMatrices(out, nullptr, maxThreads);
+	}
+	void TransformBatch::computeAffineMatrices(Affine3x4* out, Mat3* normalsOut, int maxThreads) const
+	{
+		const size_t minChunk = 2048;
+		ew::parallelFor(size(), minChunk, [this, out, normalsOut](size_t begin, size_t end) {
+			composeAffineMatrices(*this, out, normalsOut, begin, end);
+		}, maxThreads);
+	}
+	void TransformBatch::computeAffineMatrices(std::vector<Affine3x4>& out, int maxThreads) const
+	{
+		out.resize(size());
+		computeAffineMatrices(out.data(), maxThreads);
+	}
+	void TransformBatch::computeAffineMatrices(std::vector<Affine3x4>& out, std::vector<Mat3>& normalsOut, int maxThreads) const
+	{
+		out.resize(size());
+		normalsOut.resize(size());
+		computeAffineMatrices(out.data(), normalsOut.data(), maxThreads);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include "transform.h"
+
+namespace ew {
+	//Structure-of-arrays storage for large numbers of transforms.
+	//Each component lives in its own contiguous array so model matrices can be built several objects at a time.
+	struct TransformBatch {
+		std::vector<float> positionX, positionY, positionZ;
+		std::vector<float> rotationX, rotationY, rotationZ; //Euler angles (Degrees)
+		std::vector<float> scaleX, scaleY, scaleZ;
+		std::vector<float> orientationX, orientationY, orientationZ, orientationW; //Unit quaternions
+		//When set, matrices are built from the orientation quaternions (no trig) and the Euler rotations are ignored
+		bool useOrientation = false;
+		//Use ew::FastSinCos instead of sinf/cosf for the Euler path. Up to ~1e-7 error per matrix element, several times faster
+		bool fastTrig = false;
+
+		inline size_t size()const { return positionX.size(); }
+		void resize(size_t count); //New transforms are identity
+		void clear();
+		void add(const Transform& transform);
+		void set(size_t i, const Transform& transform);
+		Transform get(size_t i)const;
+
+		//Writes size() model matrices to out, which must have room for size() Mat4s.
+		//Matrices are contiguous and column major, so out can be handed straight to glBufferData.
+		//maxThreads: 1 = calling thread only, <= 0 = all job threads
+		void computeModelMatrices(Mat4* out, int maxThreads = 1)const;
+		void computeModelMatrices(std::vector<Mat4>& out, int maxThreads = 1)const;
+		//Also writes the normal matrix (inverse transpose of the 3x3 part) of each transform in the same pass
+		void computeModelMatrices(Mat4* out, Mat3* normalsOut, int maxThreads = 1)const;
+		void computeModelMatrices(std::vector<Mat4>& out, std::vector<Mat3>& normalsOut, int maxThreads = 1)const;
+		//Same as computeModelMatrices but 48 bytes per transform (see ew::Affine3x4). Matches a std430 mat3x4 array
+		void computeAffineMatrices(Affine3x4* out, int maxThreads = 1)const;
+		void computeAffineMatrices(std::vector<Affine3x4>& out, int maxThreads = 1)const;
+		void computeAffineMatrices(Affine3x4* out, Mat3* normalsOut, int maxThreads = 1)const;
+		void computeAffineMatrices(std::vector<Affine3x4>& out, std::vector<Mat3>& normalsOut, int maxThreads = 1)const;
+	};
+}
@@ -0,0 +1,151 @@
+#include "vertexFormat.h"
+#include "jobs.h"
+#include "external/glad.h"
+#include <functional>
+#include <string.h>
+
+namespace ew {
+	/// <summary>
+	/// Rebiases the exponent (127 -> 15) and rounds the mantissa from 23 to 10 bits.
+	/// Values below the smallest normal half are scaled to the subnormal step (2^-24) instead
+	/// </summary>
+	uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		const uint32_t sign = (bits >> 16) & 0x8000;
+		const uint32_t magnitude = bits & 0x7fffffff;
+		if (magnitude >= 0x7f800000) //Infinity, NaN
+			return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0);
+		if (magnitude >= 0x477ff000) //Rounds to 65520 or more
+			return sign | 0x7c00;
+		if (magnitude < 0x38800000) { //Below 2^-14
+			float subnormal;
+			memcpy(&subnormal, &magnitude, sizeof(subnormal));
+			return sign | (uint16_t)lrintf(subnormal * 16777216.0f);
+		}
+		uint32_t half = (magnitude - 0x38000000) >> 13;
+		const uint32_t rest = magnitude & 0x1fff;
+		if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+			half++;
+		return sign | half;
+	}
+	float HalfToFloat(uint16_t half)
+	{
+		const uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+		const uint32_t exponent = (half >> 10) & 0x1f;
+		const uint32_t mantissa = half & 0x3ff;
+		uint32_t bits;
+		if (exponent == 0) {
+			float subnormal = mantissa / 16777216.0f;
+			memcpy(&bits, &subnormal, sizeof(bits));
+			bits |= sign;
+		}
+		else if (exponent == 0x1f) {
+			bits = sign | 0x7f800000 | (mantissa << 13);
+		}
+		else {
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	static inline uint32_t packSnorm10(float v) {
+		v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+		return (uint32_t)(int32_t)lrintf(v * 511.0f) & 0x3ff;
+	}
+	static inline float unpackSnorm10(uint32_t bits) {
+		int32_t v = (int32_t)(bits << 22) >> 22; //Sign extend
+		float f = v / 511.0f;
+		return f < -1.0f ? -1.0f : f;
+	}
+	uint32_t PackSnorm1010102(const Vec3& v)
+	{
+		return packSnorm10(v.x) | (packSnorm10(v.y) << 10) | (packSnorm10(v.z) << 20);
+	}
+	Vec3 UnpackSnorm1010102(uint32_t packed)
+	{
+		return Vec3(unpackSnorm10(packed), unpackSnorm10(packed >> 10), unpackSnorm10(packed >> 20));
+	}
+
+	VertexLayout getVertexLayout(VertexFormat vertexFormat)
+	{
+		switch (vertexFormat) {
+		case VertexFormat::PACKED:
+			return VertexLayout{ sizeof(PackedVertex), {
+				{ 3, GL_FLOAT, GL_FALSE, offsetof(PackedVertex, pos) },
+				{ 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, normal) },
+				{ 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, uv) } } };
+		case VertexFormat::QUANTIZED:
+			return VertexLayout{ sizeof(QuantizedVertex), {
+				{ 3, GL_SHORT, GL_TRUE, offsetof(QuantizedVertex, pos) },
+				{ 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(QuantizedVertex, normal) },
+				{ 2, GL_HALF_FLOAT, GL_FALSE, offsetof(QuantizedVertex, uv) } } };
+		default:
+			return VertexLayout{ sizeof(Vertex), {
+				{ 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, pos) },
+				{ 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal) },
+				{ 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, uv) } } };
+		}
+	}
+
+	//Vertices per job when encoding
+	static const size_t ENCODE_CHUNK = 16384;
+
+	void packVertices(const Vertex* vertices, size_t count, PackedVertex* out, int maxThreads)
+	{
+		auto pack = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const Vertex& v = vertices[i];
+				out[i].pos = v.pos;
+				out[i].normal = PackSnorm1010102(v.normal);
+				out[i].uv[0] = FloatToHalf(v.uv.x);
+				out[i].uv[1] = FloatToHalf(v.uv.y);
+			}
+		};
+		parallelFor(count, ENCODE_CHUNK, std::cref(pack), maxThreads);
+	}
+
+	Affine3x4 quantizeVertices(const Vertex* vertices, size_t count, QuantizedVertex* out, int maxThreads)
+	{
+		return quantizeVertices(vertices, count, ComputeBounds(vertices, count, maxThreads).box, out, maxThreads);
+	}
+
+	/// <summary>
+	/// Positions are stored relative to the center of the bounds, in units of half their size per axis. Flat axes use a scale of 1
+	/// so they don't divide by 0. OpenGL reads normalized int16 c as c / 32767, which the returned transform scales back
+	/// </summary>
+	Affine3x4 quantizeVertices(const Vertex* vertices, size_t count, const AABB& box, QuantizedVertex* out, int maxThreads)
+	{
+		if (count == 0)
+			return AffineIdentity();
+		const Vec3 center = (box.min + box.max) * 0.5f;
+		Vec3 extent = (box.max - box.min) * 0.5f;
+		extent = Vec3(extent.x > 0.0f ? extent.x : 1.0f, extent.y > 0.0f ? extent.y : 1.0f, extent.z > 0.0f ? extent.z : 1.0f);
+		const Vec3 scale = Vec3(32767.0f / extent.x, 32767.0f / extent.y, 32767.0f / extent.z);
+
+		auto quantize = [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const Vertex& v = vertices[i];
+				const Vec3 offset = v.pos - center;
+				const Vec3 p = Vec3(offset.x * scale.x, offset.y * scale.y, offset.z * scale.z);
+				out[i].pos[0] = (int16_t)lrintf(fminf(fmaxf(p.x, -32767.0f), 32767.0f));
+				out[i].pos[1] = (int16_t)lrintf(fminf(fmaxf(p.y, -32767.0f), 32767.0f));
+				out[i].pos[2] = (int16_t)lrintf(fminf(fmaxf(p.z, -32767.0f), 32767.0f));
+				out[i].pos[3] = 0;
+				out[i].normal = PackSnorm1010102(v.normal);
+				out[i].uv[0] = FloatToHalf(v.uv.x);
+				out[i].uv[1] = FloatToHalf(v.uv.y);
+			}
+		};
+		parallelFor(count, ENCODE_CHUNK, std::cref(quantize), maxThreads);
+
+		return Affine3x4(
+			Vec4(extent.x, 0.0f, 0.0f, center.x),
+			Vec4(0.0f, extent.y, 0.0f, center.y),
+			Vec4(0.0f, 0.0f, extent.z, center.z)
+		);
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stdint.h>
+#include "mesh.h"
+
+namespace ew {
+	//IEEE 754 half float (GL_HALF_FLOAT), rounded to nearest even. Values too large for a half become infinity
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t half);
+	//Signed normalized 10:10:10 with a 2 bit w of 0, as read by GL_INT_2_10_10_10_REV. Components are clamped to [-1, 1]
+	uint32_t PackSnorm1010102(const Vec3& v);
+	Vec3 UnpackSnorm1010102(uint32_t packed);
+
+	//VertexFormat::PACKED, 20 bytes: float position, normal as GL_INT_2_10_10_10_REV, UV as half floats
+	struct PackedVertex {
+		Vec3 pos;
+		uint32_t normal;
+		uint16_t uv[2];
+	};
+	//VertexFormat::QUANTIZED, 16 bytes: position as normalized int16 within the mesh bounds (w is padding), then normal and UV as in PackedVertex
+	struct QuantizedVertex {
+		int16_t pos[4];
+		uint32_t normal;
+		uint16_t uv[2];
+	};
+
+	//One shader input of a vertex format, as given to glVertexAttribPointer
+	struct VertexAttribute {
+		uint32_t components;
+		uint32_t type; //GL_FLOAT, GL_SHORT, GL_INT_2_10_10_10_REV or GL_HALF_FLOAT
+		uint32_t normalized;
+		uint32_t offset; //Bytes from the start of the vertex
+	};
+	//Stride and attributes (position, normal, UV) of a vertex format. Mesh::load sets up its attributes from this, and mesh
+	//files store it so a reader can check the vertices match the format it expects
+	struct VertexLayout {
+		uint32_t stride;
+		VertexAttribute attributes[3];
+	};
+	VertexLayout getVertexLayout(VertexFormat vertexFormat);
+
+	//Encoders used by Mesh::load, split across the job threads for large meshes (maxThreads as in procGen)
+	void packVertices(const Vertex* vertices, size_t count, PackedVertex* out, int maxThreads = 0);
+	//Returns the transform from the quantized [-1, 1] positions back to mesh space
+	Affine3x4 quantizeVertices(const Vertex* vertices, size_t count, QuantizedVertex* out, int maxThreads = 0);
+	//Quantizes within box (e.g. MeshData::bounds) instead of scanning the vertices for it. Positions outside box are clamped to it
+	Affine3x4 quantizeVertices(const Vertex* vertices, size_t count, const AABB& box, QuantizedVertex* out, int maxThreads = 0);
+}
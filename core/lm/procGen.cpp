@@ -1,69 +1,118 @@
 #include "procGen.h"
+#include "../ew/jobs.h"
 #include <stdlib.h>
+#include <algorithm>
+#include <functional>
 
 namespace lm {
-	ew::MeshData createPlane(float width, float height, int subdivisions)
+	// Rows per parallelFor job, so each job gets enough vertices to be worth handing to a worker (small meshes stay on the calling thread)
+	// Jobs are passed as std::cref(lambda) so the std::function parameter doesn't allocate
+	static size_t rowsPerJob(size_t columns)
 	{
-		if (subdivisions < 1)
-		{
-			subdivisions = 1;
-		}
+		const size_t MIN_VERTICES_PER_JOB = 16384;
+		return std::max<size_t>(MIN_VERTICES_PER_JOB / std::max<size_t>(columns, 1), 1);
+	}
+
+	// Generators clamp their segment counts to these
+	static int clampSubdivisions(int subdivisions)
+	{
+		return subdivisions < 1 ? 1 : subdivisions;
+	}
+	static int clampSegments(int numSegments)
+	{
+		return numSegments < 3 ? 3 : numSegments;
+	}
+	// Returns true if the indices go in indices16
+	static bool resizeMeshData(ew::MeshData* meshData, ew::MeshSize size)
+	{
+		const bool use16Bit = size.numVertices <= ew::MAX_16BIT_VERTICES;
+		meshData->vertices.resize(size.numVertices);
+		meshData->indices.resize(use16Bit ? 0 : size.numIndices);
+		meshData->indices16.resize(use16Bit ? size.numIndices : 0);
+		meshData->hasBounds = false; //Scanned by Mesh::load, or updateBounds()
+		return use16Bit;
+	}
+
+	ew::MeshSize getPlaneSize(int subdivisions)
+	{
+		subdivisions = clampSubdivisions(subdivisions);
+		size_t columns = subdivisions + 1;
+		return { columns * columns, (size_t)subdivisions * subdivisions * 6 };
+	}
+
+	ew::MeshSize getCylinderSize(int numSegments)
+	{
+		numSegments = clampSegments(numSegments);
+		size_t columns = numSegments + 1;
+		// Top center, 4 rings, bottom center. Top cap, bottom cap, sides
+		return { columns * 4 + 2, (size_t)numSegments * 3 * 2 + (size_t)numSegments * 6 };
+	}
+
+	ew::MeshSize getSphereSize(int numSegments)
+	{
+		numSegments = clampSegments(numSegments);
+		size_t columns = numSegments + 1;
+		// Top cap, bottom cap (one extra triangle), side rows
+		return { columns * columns, (size_t)numSegments * 3 + (numSegments + 1) * 3 + (size_t)numSegments * 6 * (numSegments - 2) };
+	}
+
+	template<typename Index>
+	static void fillPlane(float width, float height, int subdivisions, ew::Vertex* verticesOut, Index* indicesOut, int maxThreads)
+	{
+		subdivisions = clampSubdivisions(subdivisions);
 
 		int columns = subdivisions + 1;
-		ew::MeshData mesh;
-		mesh.vertices.reserve(4);	// 4 x 1
-		mesh.indices.reserve(6);	// 6 x 1
 
 		ew::Vec3 normal = ew::Vec3(0.0f, 0.0f, 1.0f);
 		ew::Vec3 u = ew::Vec3(normal.z, normal.x, normal.y);
 		ew::Vec3 v = ew::Cross(normal, u);
 
-		// Vertices
-		for (int row = 0; row <= subdivisions; row++)
-		{
-			for (int col = 0; col <= subdivisions; col++)
-			{
-				ew::Vertex vertex;
-				vertex.pos -= (u + v) * (1 / columns);
-				vertex.pos += (u * col + v * row);
-				vertex.pos.x *= width;
-				vertex.pos.y *= height;
-				vertex.normal = normal;
-				//vertex.uv = ew::Vec2(col * (width / (subdivisions - width)), row * (height / (subdivisions - height)));
-				vertex.uv = ew::Vec2(col * 2 * (width / subdivisions), row * 2 * (height / subdivisions));
-				mesh.vertices.push_back(vertex);
-			}
-		}
-
-		// Indices
-		for (int row = 0; row < subdivisions; row++)
-		{
-			for (int col = 0; col < subdivisions; col++)
+		// Every row writes its own slice of the vertex and index arrays
+		auto fillRows = [&](size_t rowBegin, size_t rowEnd) {
+			for (int row = (int)rowBegin; row < (int)rowEnd; row++)
 			{
-				unsigned int startVertex = row * columns + col;
-
-				mesh.indices.push_back(startVertex);
-				mesh.indices.push_back(startVertex + 1);
-				mesh.indices.push_back(startVertex + columns + 1);
-				mesh.indices.push_back(startVertex + columns + 1);
-				mesh.indices.push_back(startVertex + columns);
-				mesh.indices.push_back(startVertex);
+				// Vertices
+				for (int col = 0; col <= subdivisions; col++)
+				{
+					ew::Vertex& vertex = verticesOut[(size_t)row * columns + col];
+					vertex.pos = ew::Vec3(0.0f);
+					vertex.pos -= (u + v) * (1 / columns);
+					vertex.pos += (u * col + v * row);
+					vertex.pos.x *= width;
+					vertex.pos.y *= height;
+					vertex.normal = normal;
+					//vertex.uv = ew::Vec2(col * (width / (subdivisions - width)), row * (height / (subdivisions - height)));
+					vertex.uv = ew::Vec2(col * 2 * (width / subdivisions), row * 2 * (height / subdivisions));
+				}
+
+				// Indices
+				if (row == subdivisions)
+				{
+					continue;
+				}
+				Index* indices = indicesOut + (size_t)row * subdivisions * 6;
+				for (int col = 0; col < subdivisions; col++)
+				{
+					unsigned int startVertex = row * columns + col;
+
+					*indices++ = startVertex;
+					*indices++ = startVertex + 1;
+					*indices++ = startVertex + columns + 1;
+					*indices++ = startVertex + columns + 1;
+					*indices++ = startVertex + columns;
+					*indices++ = startVertex;
+				}
 			}
-		}
-		
-		return mesh;
+		};
+		ew::parallelFor(columns, rowsPerJob(columns), std::cref(fillRows), maxThreads);
 	}
 
-	ew::MeshData createCylinder(float height, float radius, int numSegments)
+	template<typename Index>
+	static void fillCylinder(float height, float radius, int numSegments, ew::Vertex* verticesOut, Index* indicesOut, int maxThreads)
 	{
-		if (numSegments < 3)
-		{
-			numSegments = 3;
-		}
+		numSegments = clampSegments(numSegments);
 
-		ew::MeshData mesh;
-		mesh.vertices.reserve(4);	// 4 x 1
-		mesh.indices.reserve(6);	// 6 x 1
+		int columns = numSegments + 1;
 
 		ew::Vec3 normal = ew::Vec3(0.0f, 1.0f, 0.0f);
 		ew::Vec3 u = ew::Vec3(normal.z, normal.x, normal.y);
@@ -76,137 +125,98 @@ namespace lm {
 		// Vertices
 
 		// Top Center
-		ew::Vertex topV;
+		ew::Vertex& topV = verticesOut[0];
 		topV.pos = ew::Vec3(0, topY, 0);
 		topV.normal = normal;
 		topV.uv = ew::Vec2(0.5, 0.5);
-		mesh.vertices.push_back(topV);
-
-		// Top Ring -- Up
-		for (int i = 0; i <= numSegments; i++)
-		{
-			float theta = i * thetaStep;
-			ew::Vertex topRingVertex;
-			topRingVertex.pos = ew::Vec3(cos(theta) * radius, topY, sin(theta) * radius);
-			topRingVertex.normal = normal;
-			topRingVertex.uv = ew::Vec2(cos(theta) / 2 + 0.5, sin(theta) / 2 + 0.5);
-			mesh.vertices.push_back(topRingVertex);
-		}
-		
-		// Top Ring -- Out
-		for (int i = 0; i <= numSegments; i++)
-		{
-			float theta = i * thetaStep;
-			ew::Vertex topRingVertex;
-			topRingVertex.pos = ew::Vec3(cos(theta) * radius, topY, sin(theta) * radius);
-			topRingVertex.normal = ew::Vec3(cos(theta) / numSegments, 0, sin(theta) / numSegments);
-			topRingVertex.uv = ew::Vec2(theta / numSegments, 1);
-			mesh.vertices.push_back(topRingVertex);
-
-			/*
-			if (i == numSegments)
-			{
-				float theta = i * thetaStep;
-				ew::Vertex topRingVertex;
-				topRingVertex.pos = ew::Vec3(cos(theta) * radius, topY, sin(theta) * radius);
-				topRingVertex.normal = ew::Vec3(cos(theta) / numSegments, 0, sin(theta) / numSegments);
-				topRingVertex.uv = ew::Vec2(theta / numSegments, 1);
-				mesh.vertices.push_back(topRingVertex);
-			}*/
-		}
-
-		// Bottom Ring - Out
-		for (int i = 0; i <= numSegments; i++)
-		{
-			float theta = i * thetaStep;
-			ew::Vertex bottomRingVertex;
-			bottomRingVertex.pos = ew::Vec3(cos(theta) * radius, bottomY, sin(theta) * radius);
-			bottomRingVertex.normal = ew::Vec3(cos(theta) / numSegments, 0, sin(theta) / numSegments);
-			bottomRingVertex.uv = ew::Vec2(theta / numSegments, 0);
-			mesh.vertices.push_back(bottomRingVertex);
-
-			/*
-			if (i == numSegments)
-			{
-				float theta = i * thetaStep;
-				ew::Vertex bottomRingVertex;
-				bottomRingVertex.pos = ew::Vec3(cos(theta) * radius, bottomY, sin(theta) * radius);
-				bottomRingVertex.normal = ew::Vec3(cos(theta) / numSegments, 0, sin(theta) / numSegments);
-				bottomRingVertex.uv = ew::Vec2(theta / numSegments, 0);
-				mesh.vertices.push_back(bottomRingVertex);
-			}*/
-		}
-		
-		// Bottom Ring - Down
-		for (int i = 0; i <= numSegments; i++)
-		{
-			float theta = i * thetaStep;
-			ew::Vertex bottomRingVertex;
-			bottomRingVertex.pos = ew::Vec3(cos(theta) * radius, bottomY, sin(theta) * radius);
-			bottomRingVertex.normal = -normal;
-			bottomRingVertex.uv = ew::Vec2(cos(theta) / 2 + 0.5, sin(theta) / 2 + 0.5);
-			mesh.vertices.push_back(bottomRingVertex);
-		}
 
 		// Bottom Center
-		ew::Vertex bottomV;
+		ew::Vertex& bottomV = verticesOut[columns * 4 + 1];
 		bottomV.pos = ew::Vec3(0, bottomY, 0);
 		bottomV.normal = -normal;
 		bottomV.uv = ew::Vec2(0.5, 0.5);
-		mesh.vertices.push_back(bottomV); 
 
-		// Indices
-		int columns = numSegments + 1;
-
-		// Bottom Cap
-		int start = 1;
-		int center = 0;
-
-		for (int i = 0; i < numSegments * 2; i++)
-		{
-			mesh.indices.push_back(start + i);
-			mesh.indices.push_back(center);
-			mesh.indices.push_back(start + i + 1);
-		}
-
-		// Top Cap
-		start = numSegments * 4 + 6;
-		center = numSegments * 4 + 5;
+		// Each job fills the same range of every ring
+		auto fillRings = [&](size_t begin, size_t end) {
+			for (int i = (int)begin; i < (int)end; i++)
+			{
+				float theta = i * thetaStep;
 
-		for (int i = 0; i <= numSegments * 2 + 1; i++)
-		{
-			mesh.indices.push_back(start - i);
-			mesh.indices.push_back(center);
-			mesh.indices.push_back(start - i - 1);
-		}
+				// Top Ring -- Up
+				ew::Vertex& topRingUp = verticesOut[1 + i];
+				topRingUp.pos = ew::Vec3(cos(theta) * radius, topY, sin(theta) * radius);
+				topRingUp.normal = normal;
+				topRingUp.uv = ew::Vec2(cos(theta) / 2 + 0.5, sin(theta) / 2 + 0.5);
+
+				// Top Ring -- Out
+				ew::Vertex& topRingOut = verticesOut[1 + columns + i];
+				topRingOut.pos = ew::Vec3(cos(theta) * radius, topY, sin(theta) * radius);
+				topRingOut.normal = ew::Vec3(cos(theta) / numSegments, 0, sin(theta) / numSegments);
+				topRingOut.uv = ew::Vec2(theta / numSegments, 1);
+
+				// Bottom Ring - Out
+				ew::Vertex& bottomRingOut = verticesOut[1 + columns * 2 + i];
+				bottomRingOut.pos = ew::Vec3(cos(theta) * radius, bottomY, sin(theta) * radius);
+				bottomRingOut.normal = ew::Vec3(cos(theta) / numSegments, 0, sin(theta) / numSegments);
+				bottomRingOut.uv = ew::Vec2(theta / numSegments, 0);
+
+				// Bottom Ring - Down
+				ew::Vertex& bottomRingDown = verticesOut[1 + columns * 3 + i];
+				bottomRingDown.pos = ew::Vec3(cos(theta) * radius, bottomY, sin(theta) * radius);
+				bottomRingDown.normal = -normal;
+				bottomRingDown.uv = ew::Vec2(cos(theta) / 2 + 0.5, sin(theta) / 2 + 0.5);
+			}
+		};
+		ew::parallelFor(columns, rowsPerJob(4), std::cref(fillRings), maxThreads);
 
-		// Side
-		int sideStart = numSegments + 1;
-		for (int i = 0; i < numSegments * 2; i++)
-		{
-			start = sideStart + i;
-
-			mesh.indices.push_back(start);
-			mesh.indices.push_back(start + 1);
-			mesh.indices.push_back(start + columns + 1);
-			mesh.indices.push_back(start + columns + 1);
-			mesh.indices.push_back(start + columns);
-			mesh.indices.push_back(start);
-		}
+		// Indices
+		Index* topCapIndices = indicesOut;
+		Index* bottomCapIndices = topCapIndices + numSegments * 3;
+		Index* sideIndices = bottomCapIndices + numSegments * 3;
 
-		return mesh;
+		// Every segment writes one triangle of each cap and one side quad
+		auto fillIndices = [&](size_t begin, size_t end) {
+			for (int i = (int)begin; i < (int)end; i++)
+			{
+				// Top Cap, around the top center from the "up" ring
+				int start = 1;
+				int center = 0;
+				Index* indices = topCapIndices + i * 3;
+				indices[0] = start + i;
+				indices[1] = center;
+				indices[2] = start + i + 1;
+
+				// Bottom Cap, around the bottom center from the "down" ring
+				start = 1 + columns * 3;
+				center = 1 + columns * 4;
+				indices = bottomCapIndices + i * 3;
+				indices[0] = start + i + 1;
+				indices[1] = center;
+				indices[2] = start + i;
+
+				// Side, from the top "out" ring to the bottom one
+				start = 1 + columns + i;
+				indices = sideIndices + i * 6;
+				indices[0] = start;
+				indices[1] = start + 1;
+				indices[2] = start + columns + 1;
+				indices[3] = start + columns + 1;
+				indices[4] = start + columns;
+				indices[5] = start;
+			}
+		};
+		ew::parallelFor(numSegments, rowsPerJob(6), std::cref(fillIndices), maxThreads);
 	}
 
-	ew::MeshData createSphere(float radius, int numSegments)
+	template<typename Index>
+	static void fillSphere(float radius, int numSegments, ew::Vertex* verticesOut, Index* indicesOut, int maxThreads)
 	{
-		if (numSegments < 3)
-		{
-			numSegments = 3;
-		}
+		numSegments = clampSegments(numSegments);
 
-		ew::MeshData mesh;
-		mesh.vertices.reserve(4);	// 4 x 1
-		mesh.indices.reserve(6);	// 6 x 1
+		int columns = numSegments + 1;
+		size_t topCapCount = numSegments * 3;
+		size_t bottomCapCount = (numSegments + 1) * 3;
+		size_t rowCount = numSegments * 6;
 
 		ew::Vec3 normal = ew::Vec3(0.0f, 1.0f, 0.0f);
 		ew::Vec3 u = ew::Vec3(normal.z, normal.x, normal.y);
@@ -214,26 +224,27 @@ namespace lm {
 
 		float thetaStep = 2 * ew::PI / numSegments;
 		float phiStep = ew::PI / numSegments;
-		float phi = 0;
-		float theta = 0;
 
 		// Vertices
-		for (int row = 0; row <= numSegments; row++) //First and last row converge at poles
-		{
-			phi = row * phiStep;
-
-			for (int col = 0; col <= numSegments; col++) //Duplicate column for each row
+		auto fillRows = [&](size_t rowBegin, size_t rowEnd) {
+			for (int row = (int)rowBegin; row < (int)rowEnd; row++) //First and last row converge at poles
 			{
-				theta = col * thetaStep;
-				ew::Vertex ringVertex;
-				ringVertex.pos = ew::Vec3(radius * cos(theta) * sin(phi), radius * cos(phi), radius * sin(theta) * sin(phi));
-				ringVertex.normal = ew::Normalize(ringVertex.pos);
-				ringVertex.uv = ew::Vec2(theta / numSegments, phi / numSegments * 2); 
-				mesh.vertices.push_back(ringVertex);
+				float phi = row * phiStep;
+
+				for (int col = 0; col <= numSegments; col++) //Duplicate column for each row
+				{
+					float theta = col * thetaStep;
+					ew::Vertex& ringVertex = verticesOut[(size_t)row * columns + col];
+					ringVertex.pos = ew::Vec3(radius * cos(theta) * sin(phi), radius * cos(phi), radius * sin(theta) * sin(phi));
+					ringVertex.normal = ew::Normalize(ringVertex.pos);
+					ringVertex.uv = ew::Vec2(theta / numSegments, phi / numSegments * 2);
+				}
 			}
-		}
+		};
+		ew::parallelFor(columns, rowsPerJob(columns), std::cref(fillRows), maxThreads);
 
 		// Indices
+		Index* indices = indicesOut;
 
 		// Top Cap
 		int poleStart = 0;
@@ -241,9 +252,9 @@ namespace lm {
 
 		for (int i = 0; i < numSegments; i++)
 		{
-			mesh.indices.push_back(sideStart + i);
-			mesh.indices.push_back(poleStart + i);	//Pole
-			mesh.indices.push_back(sideStart + i + 1);
+			*indices++ = sideStart + i;
+			*indices++ = poleStart + i;	//Pole
+			*indices++ = sideStart + i + 1;
 		}
 
 		// Bottom Cap
@@ -252,29 +263,104 @@ namespace lm {
 
 		for (int i = 0; i <= numSegments; i++)
 		{
-			mesh.indices.push_back(sideStart - i);
-			mesh.indices.push_back(poleStart - i);	//Pole
-			mesh.indices.push_back(sideStart - i - 1);
+			*indices++ = sideStart - i;
+			*indices++ = poleStart - i;	//Pole
+			*indices++ = sideStart - i - 1;
 		}
 
-		// Side
-		int columns = numSegments + 1;
-
-		for (int row = 1; row < numSegments - 1; row++)
-		{
-			for (int col = 0; col < numSegments; col++)
+		// Side -- rows 1 to numSegments - 2, each filling its own slice after the caps
+		auto fillSideRows = [&](size_t rowBegin, size_t rowEnd) {
+			for (int row = (int)rowBegin + 1; row < (int)rowEnd + 1; row++)
 			{
-				int start = row * columns + col;
-
-				mesh.indices.push_back(start);
-				mesh.indices.push_back(start + 1);
-				mesh.indices.push_back(start + columns + 1);
-				mesh.indices.push_back(start + columns + 1);
-				mesh.indices.push_back(start + columns);
-				mesh.indices.push_back(start);
+				Index* rowIndices = indicesOut + topCapCount + bottomCapCount + (row - 1) * rowCount;
+				for (int col = 0; col < numSegments; col++)
+				{
+					int start = row * columns + col;
+
+					*rowIndices++ = start;
+					*rowIndices++ = start + 1;
+					*rowIndices++ = start + columns + 1;
+					*rowIndices++ = start + columns + 1;
+					*rowIndices++ = start + columns;
+					*rowIndices++ = start;
+				}
 			}
-		}
+		};
+		ew::parallelFor(numSegments - 2, rowsPerJob(columns), std::cref(fillSideRows), maxThreads);
+	}
 
+	void createPlane(float width, float height, int subdivisions, ew::Vertex* verticesOut, unsigned int* indicesOut, int maxThreads)
+	{
+		fillPlane(width, height, subdivisions, verticesOut, indicesOut, maxThreads);
+	}
+
+	void createPlane(float width, float height, int subdivisions, ew::Vertex* verticesOut, unsigned short* indicesOut, int maxThreads)
+	{
+		fillPlane(width, height, subdivisions, verticesOut, indicesOut, maxThreads);
+	}
+
+	ew::MeshData createPlane(float width, float height, int subdivisions, int maxThreads)
+	{
+		ew::MeshData mesh;
+		createPlane(width, height, subdivisions, &mesh, maxThreads);
 		return mesh;
 	}
+
+	void createPlane(float width, float height, int subdivisions, ew::MeshData* meshData, int maxThreads)
+	{
+		if (resizeMeshData(meshData, getPlaneSize(subdivisions)))
+			fillPlane(width, height, subdivisions, meshData->vertices.data(), meshData->indices16.data(), maxThreads);
+		else
+			fillPlane(width, height, subdivisions, meshData->vertices.data(), meshData->indices.data(), maxThreads);
+	}
+
+	void createCylinder(float height, float radius, int numSegments, ew::Vertex* verticesOut, unsigned int* indicesOut, int maxThreads)
+	{
+		fillCylinder(height, radius, numSegments, verticesOut, indicesOut, maxThreads);
+	}
+
+	void createCylinder(float height, float radius, int numSegments, ew::Vertex* verticesOut, unsigned short* indicesOut, int maxThreads)
+	{
+		fillCylinder(height, radius, numSegments, verticesOut, indicesOut, maxThreads);
+	}
+
+	ew::MeshData createCylinder(float height, float radius, int numSegments, int maxThreads)
+	{
+		ew::MeshData mesh;
+		createCylinder(height, radius, numSegments, &mesh, maxThreads);
+		return mesh;
+	}
+
+	void createCylinder(float height, float radius, int numSegments, ew::MeshData* meshData, int maxThreads)
+	{
+		if (resizeMeshData(meshData, getCylinderSize(numSegments)))
+			fillCylinder(height, radius, numSegments, meshData->vertices.data(), meshData->indices16.data(), maxThreads);
+		else
+			fillCylinder(height, radius, numSegments, meshData->vertices.data(), meshData->indices.data(), maxThreads);
+	}
+
+	void createSphere(float radius, int numSegments, ew::Vertex* verticesOut, unsigned int* indicesOut, int maxThreads)
+	{
+		fillSphere(radius, numSegments, verticesOut, indicesOut, maxThreads);
+	}
+
+	void createSphere(float radius, int numSegments, ew::Vertex* verticesOut, unsigned short* indicesOut, int maxThreads)
+	{
+		fillSphere(radius, numSegments, verticesOut, indicesOut, maxThreads);
+	}
+
+	ew::MeshData createSphere(float radius, int numSegments, int maxThreads)
+	{
+		ew::MeshData mesh;
+		createSphere(radius, numSegments, &mesh, maxThreads);
+		return mesh;
+	}
+
+	void createSphere(float radius, int numSegments, ew::MeshData* meshData, int maxThreads)
+	{
+		if (resizeMeshData(meshData, getSphereSize(numSegments)))
+			fillSphere(radius, numSegments, meshData->vertices.data(), meshData->indices16.data(), maxThreads);
+		else
+			fillSphere(radius, numSegments, meshData->vertices.data(), meshData->indices.data(), maxThreads);
+	}
 }
\ No newline at end of file
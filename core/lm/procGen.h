@@ -2,7 +2,24 @@
 #include "../ew/mesh.h"
 #include "../ew/ewMath/ewMath.h"
 namespace lm {
-	ew::MeshData createSphere(float radius, int numSegments);
-	ew::MeshData createCylinder(float height, float radius, int numSegments);
-	ew::MeshData createPlane(float width, float height, int subdivisions);
-}
+	// Exact sizes of the meshes created below, for the same parameters
+	ew::MeshSize getSphereSize(int numSegments);
+	ew::MeshSize getCylinderSize(int numSegments);
+	ew::MeshSize getPlaneSize(int subdivisions);
+
+	// Large meshes are built on the job threads (maxThreads: 1 = calling thread only, <= 0 = all). Output doesn't depend on the thread count
+	// The MeshData* overloads resize and reuse the given mesh. The pointer overloads fill caller buffers with room for get*Size() and don't allocate
+	// The MeshData forms store 16 bit indices (indices16) when the vertex count allows it. 16 bit buffers need get*Size().numVertices <= ew::MAX_16BIT_VERTICES
+	ew::MeshData createSphere(float radius, int numSegments, int maxThreads = 0);
+	void createSphere(float radius, int numSegments, ew::MeshData* meshData, int maxThreads = 0);
+	void createSphere(float radius, int numSegments, ew::Vertex* verticesOut, unsigned int* indicesOut, int maxThreads = 0);
+	void createSphere(float radius, int numSegments, ew::Vertex* verticesOut, unsigned short* indicesOut, int maxThreads = 0);
+	ew::MeshData createCylinder(float height, float radius, int numSegments, int maxThreads = 0);
+	void createCylinder(float height, float radius, int numSegments, ew::MeshData* meshData, int maxThreads = 0);
+	void createCylinder(float height, float radius, int numSegments, ew::Vertex* verticesOut, unsigned int* indicesOut, int maxThreads = 0);
+	void createCylinder(float height, float radius, int numSegments, ew::Vertex* verticesOut, unsigned short* indicesOut, int maxThreads = 0);
+	ew::MeshData createPlane(float width, float height, int subdivisions, int maxThreads = 0);
+	void createPlane(float width, float height, int subdivisions, ew::MeshData* meshData, int maxThreads = 0);
+	void createPlane(float width, float height, int subdivisions, ew::Vertex* verticesOut, unsigned int* indicesOut, int maxThreads = 0);
+	void createPlane(float width, float height, int subdivisions, ew::Vertex* verticesOut, unsigned short* indicesOut, int maxThreads = 0);
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "../ew/ewMath/ewMath.h"
 #include "../ew/ewMath/mat4.h"
+#include "../ew/ewMath/transformations.h"
 #include "../ew/ewMath/vec3.h"
 #include <cmath>
 #include <vector>
@@ -66,13 +67,29 @@ namespace lm {
 		);
 	};
 
-	struct Transform {
-		ew::Vec3 position = ew::Vec3(0.0f, 0.0f, 0.0f);
-		ew::Vec3 rotation = ew::Vec3(0.0f, 0.0f, 0.0f); //Euler angles (degrees)
-		ew::Vec3 scale = ew::Vec3(1.0f, 1.0f, 1.0f);
-		ew::Mat4 getModelMatrix() const {
-			return Translate(position) * (RotateY(rotation.y) * RotateX(rotation.x) * RotateZ(rotation.z)) * Scale(scale);
+	//Model matrix is cached and only rebuilt after a setter is called
+	class Transform {
+	public:
+		inline const ew::Vec3& getPosition()const { return m_position; }
+		inline const ew::Vec3& getRotation()const { return m_rotation; }
+		inline const ew::Vec3& getScale()const { return m_scale; }
+		inline void setPosition(const ew::Vec3& position) { m_position = position; m_dirty = true; }
+		inline void setRotation(const ew::Vec3& rotation) { m_rotation = rotation; m_dirty = true; }
+		inline void setScale(const ew::Vec3& scale) { m_scale = scale; m_dirty = true; }
+		const ew::Mat4& getModelMatrix() const {
+			if (m_dirty) {
+				//Same as Translate * (RotateY * RotateX * RotateZ) * Scale, without the multiplies
+				m_modelMatrix = ew::TRS(m_position, m_rotation * ew::DEG2RAD, m_scale);
+				m_dirty = false;
+			}
+			return m_modelMatrix;
 		}
+	private:
+		ew::Vec3 m_position = ew::Vec3(0.0f, 0.0f, 0.0f);
+		ew::Vec3 m_rotation = ew::Vec3(0.0f, 0.0f, 0.0f); //Euler angles (degrees)
+		ew::Vec3 m_scale = ew::Vec3(1.0f, 1.0f, 1.0f);
+		mutable ew::Mat4 m_modelMatrix;
+		mutable bool m_dirty = true;
 	};
 
 	//Creates a right handed view space
@@ -0,0 +1,153 @@
+/*
+	Checks that Mat4 * Mat4 and Mat4 * Vec4 give the same results as MulScalar, the reference implementation, over random inputs.
+	Both the SIMD functions (MulSimd) and the operators, which pick a path at compile time, are compared.
+	Results must match bit for bit unless the compiler may contract multiply-adds into FMAs (__FP_FAST_FMAF, e.g. AArch64 or
+	-mfma), in which case each component may differ by a few roundings of its terms.
+	Exits with 1 on a mismatch.
+
+	Usage: ewmath_test [options]
+		--count <n>          Random cases per check (default 100000)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+
+#include <ew/ewMath/mat4.h>
+
+#if defined(EW_SIMD_AVX)
+const char* SIMD_VARIANT = "avx";
+#elif defined(EW_SIMD_SSE)
+const char* SIMD_VARIANT = "sse";
+#elif defined(EW_SIMD_NEON)
+const char* SIMD_VARIANT = "neon";
+#else
+const char* SIMD_VARIANT = "none";
+#endif
+
+#if defined(__FP_FAST_FMAF)
+const bool BIT_EXACT = false;
+#else
+const bool BIT_EXACT = true;
+#endif
+
+//xorshift32, so the inputs are the same on every platform
+static uint32_t state = 2463534242u;
+static uint32_t nextRandom() {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+//Random sign, mantissa and exponent within 2^-20..2^20, with some exact zeros of either sign
+static float randomFloat() {
+	const uint32_t r = nextRandom();
+	const float sign = (r & 1) ? -1.0f : 1.0f;
+	if ((r >> 1) % 32 == 0)
+		return sign * 0.0f;
+	const float mantissa = 1.0f + (float)(nextRandom() >> 8) / 16777216.0f;
+	return sign * ldexpf(mantissa, (int)((r >> 6) % 41) - 20);
+}
+static ew::Vec4 randomVec4() {
+	const float x = randomFloat(), y = randomFloat(), z = randomFloat();
+	return ew::Vec4(x, y, z, randomFloat());
+}
+static ew::Mat4 randomMat4() {
+	const ew::Vec4 c0 = randomVec4(), c1 = randomVec4(), c2 = randomVec4();
+	return ew::Mat4(c0, c1, c2, randomVec4());
+}
+
+/// <summary>
+/// Whether result matches the reference component expected = row . v. With contraction, each of the 3 adds can skip one rounding
+/// of a product, so the difference is bounded by a few epsilons of the sum of the terms' magnitudes
+/// </summary>
+static bool matches(float result, float expected, const ew::Mat4& m, int row, const ew::Vec4& v) {
+	if (memcmp(&result, &expected, sizeof(float)) == 0)
+		return true;
+	if (BIT_EXACT)
+		return false;
+	double magnitude = 0.0;
+	for (int i = 0; i < 4; i++)
+	{
+		magnitude += fabs((double)m[i][row] * (double)(&v.x)[i]);
+	}
+	return fabs((double)result - (double)expected) <= 8.0 * FLT_EPSILON * magnitude;
+}
+static bool matches(const ew::Vec4& result, const ew::Vec4& expected, const ew::Mat4& m, const ew::Vec4& v) {
+	for (int row = 0; row < 4; row++)
+	{
+		if (!matches((&result.x)[row], (&expected.x)[row], m, row, v))
+			return false;
+	}
+	return true;
+}
+
+struct Check {
+	const char* name;
+	int failures = 0;
+	void report(bool ok, const ew::Mat4& m) {
+		if (ok)
+			return;
+		if (failures++ == 0) {
+			printf("%s: first mismatch for\n", name);
+			for (int row = 0; row < 4; row++)
+			{
+				printf("  %a %a %a %a\n", m[0][row], m[1][row], m[2][row], m[3][row]);
+			}
+		}
+	}
+};
+
+int main(int argc, char** argv) {
+	int count = 100000;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--count") && i + 1 < argc)
+			count = atoi(argv[++i]);
+		else {
+			printf("Unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	printf("SIMD: %s, expecting %s results\n", SIMD_VARIANT, BIT_EXACT ? "bit-exact" : "FMA-bounded");
+
+	Check checks[] = { { "operator*(Mat4, Vec4)" }, { "operator*(Mat4, Mat4)" }, { "MulSimd(Mat4, Vec4)" }, { "MulSimd(Mat4, Mat4)" } };
+	for (int i = 0; i < count; i++)
+	{
+		const ew::Mat4 l = randomMat4();
+		const ew::Mat4 r = randomMat4();
+		const ew::Vec4 v = randomVec4();
+		const ew::Vec4 expectedVec = ew::MulScalar(l, v);
+		const ew::Mat4 expectedMat = ew::MulScalar(l, r);
+		auto matchesMat = [&](const ew::Mat4& result) {
+			for (int c = 0; c < 4; c++)
+			{
+				if (!matches(result[c], expectedMat[c], l, r[c]))
+					return false;
+			}
+			return true;
+		};
+		checks[0].report(matches(l * v, expectedVec, l, v), l);
+		checks[1].report(matchesMat(l * r), l);
+#if defined(EW_SIMD)
+		checks[2].report(matches(ew::MulSimd(l, v), expectedVec, l, v), l);
+		checks[3].report(matchesMat(ew::MulSimd(l, r)), l);
+#endif
+	}
+
+#if defined(EW_SIMD)
+	const int numChecks = 4;
+#else
+	const int numChecks = 2; //No MulSimd
+#endif
+	int failures = 0;
+	for (int i = 0; i < numChecks; i++)
+	{
+		printf("%-24s %d / %d mismatches\n", checks[i].name, checks[i].failures, count);
+		failures += checks[i].failures;
+	}
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+/*
+	Simplifies spheres from the generators, to a target size and to an error limit, and checks that
+		- the reported error stays within maxError
+		- the reported error is not 0 once vertices had to move off the surface (dense meshes used to round it away)
+		- the surface moves no further from the true sphere than MAX_DEVIATION_RATIO times the reported error, on top of
+		  how far the input already was. The reported error measures the kept vertices, not the sag of the larger triangles
+		  between them, so the ratio is above 1 (see ew/simplify.h)
+	Exits with 1 if a check fails.
+*/
+
+#include <stdio.h>
+#include <ew/procGen.h>
+#include <ew/simplify.h>
+
+const float RADIUS = 1.0f;
+const float MAX_DEVIATION_RATIO = 8.0f;
+
+static int failures = 0;
+
+/// <summary>
+/// maxError < 0 simplifies to targetFraction of the triangles without an error limit
+/// </summary>
+static void check(const char* name, const ew::MeshData& meshData, float targetFraction, float maxError) {
+	const size_t target = (size_t)(meshData.getNumIndices() / 3 * targetFraction) * 3;
+	float error = 0.0f;
+	const ew::MeshData result = ew::simplify(meshData, target, maxError < 0.0f ? 1e9f : maxError, &error);
+	const float inputDeviation = ew::getSphereError(meshData, RADIUS) * RADIUS;
+	const float deviation = ew::getSphereError(result, RADIUS) * RADIUS;
+	const float bound = inputDeviation + MAX_DEVIATION_RATIO * error;
+
+	bool ok = deviation <= bound;
+	if (maxError >= 0.0f)
+		ok = ok && error <= maxError;
+	//Every collapse on a sphere moves a vertex off some plane it had
+	if (result.getNumIndices() < meshData.getNumIndices())
+		ok = ok && error > 0.0f;
+	char limit[16] = "no limit";
+	if (maxError >= 0.0f)
+		snprintf(limit, sizeof(limit), "max %.0e", maxError);
+	printf("%-28s %8zu -> %8zu triangles, error %.3e (%s), deviation %.3e -> %.3e (bound %.3e) %s\n",
+		name, meshData.getNumIndices() / 3, result.getNumIndices() / 3, error, limit, inputDeviation, deviation, bound, ok ? "ok" : "FAILED");
+	if (!ok)
+		failures++;
+}
+
+int main() {
+	const ew::MeshData dense = ew::createSphere(RADIUS, 708);
+	check("uv sphere 708, 25%", dense, 0.25f, -1.0f);
+	check("uv sphere 708, max 1e-4", dense, 0.0f, 1e-4f);
+	check("uv sphere 708, max 1e-3", dense, 0.0f, 1e-3f);
+
+	const ew::MeshData sphere = ew::createSphere(RADIUS, 128);
+	check("uv sphere 128, 10%", sphere, 0.1f, -1.0f);
+	check("uv sphere 128, max 1e-3", sphere, 0.0f, 1e-3f);
+	check("uv sphere 128, max 1e-2", sphere, 0.0f, 1e-2f);
+
+	const ew::MeshData cubeSphere = ew::createCubeSphere(RADIUS, 64);
+	check("cube sphere 64, max 1e-3", cubeSphere, 0.0f, 1e-3f);
+	const ew::MeshData icosphere = ew::createIcosphere(RADIUS, 6);
+	check("icosphere 6, max 1e-3", icosphere, 0.0f, 1e-3f);
+
+	printf("%d failed\n", failures);
+	return failures > 0 ? 1 : 0;
+}
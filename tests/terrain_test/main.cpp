@@ -0,0 +1,77 @@
+/*
+	Builds pairs of neighboring ew::Terrain chunks, along x and along z, for every pairing of LODs, and checks that the
+	vertices their triangles use on the shared edge are the same set, bit for bit. Anything else leaves a crack or a T-junction.
+	Chunks are built with buildChunk, so no OpenGL context is needed.
+	Exits with 1 if an edge doesn't match.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <set>
+#include <tuple>
+#include <algorithm>
+
+#include <ew/terrain.h>
+
+typedef std::tuple<uint32_t, uint32_t, uint32_t> PositionBits;
+
+static uint32_t bitsOf(float f) {
+	uint32_t bits;
+	memcpy(&bits, &f, sizeof(bits));
+	return bits;
+}
+
+/// <summary>
+/// Positions of the vertices the triangles use on the line x = edge (alongX) or z = edge
+/// </summary>
+static std::set<PositionBits> getEdgeVertices(const ew::MeshData& meshData, bool alongX, float edge) {
+	std::set<PositionBits> positions;
+	for (size_t i = 0; i < meshData.getNumIndices(); i++)
+	{
+		const ew::Vec3& p = meshData.vertices[meshData.getIndex(i)].pos;
+		if ((alongX ? p.x : p.z) == edge)
+			positions.insert(PositionBits(bitsOf(p.x), bitsOf(p.y), bitsOf(p.z)));
+	}
+	return positions;
+}
+
+int main() {
+	const ew::Terrain terrain;
+	const ew::TerrainSettings& settings = terrain.getSettings();
+	int failures = 0;
+	int numChecks = 0;
+	ew::MeshData a, b;
+	for (int lodA = 0; lodA < settings.numLods; lodA++)
+	{
+		for (int lodB = 0; lodB < settings.numLods; lodB++)
+		{
+			//The finer chunk matches the coarser one's edge
+			const int edgeLod = std::max(lodA, lodB);
+			for (int alongX = 0; alongX < 2; alongX++)
+			{
+				//Chunk (3, -2) and its +x or +z neighbor, away from the origin so coordinates aren't trivially small.
+				//Edge LODs are -x, +x, -z, +z
+				int edgeLodsA[4] = { lodA, lodA, lodA, lodA };
+				int edgeLodsB[4] = { lodB, lodB, lodB, lodB };
+				edgeLodsA[alongX ? 1 : 3] = edgeLod;
+				edgeLodsB[alongX ? 0 : 2] = edgeLod;
+				terrain.buildChunk(3, -2, lodA, edgeLodsA, &a);
+				terrain.buildChunk(alongX ? 4 : 3, alongX ? -2 : -1, lodB, edgeLodsB, &b);
+				const float edge = (alongX ? 4 : -1) * settings.chunkSize;
+
+				const std::set<PositionBits> edgeA = getEdgeVertices(a, alongX, edge);
+				const std::set<PositionBits> edgeB = getEdgeVertices(b, alongX, edge);
+				const size_t expected = (size_t)(settings.chunkResolution >> edgeLod) + 1;
+				numChecks++;
+				if (edgeA != edgeB || edgeA.size() != expected) {
+					printf("LOD %d / %d, %s edge: %zu and %zu vertices (expected %zu), %s\n", lodA, lodB, alongX ? "x" : "z",
+						edgeA.size(), edgeB.size(), expected, edgeA == edgeB ? "same positions" : "positions differ");
+					failures++;
+				}
+			}
+		}
+	}
+	printf("%d / %d shared edges matched\n", numChecks - failures, numChecks);
+	return failures > 0 ? 1 : 0;
+}
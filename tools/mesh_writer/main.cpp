@@ -0,0 +1,166 @@
+/*
+	Generates an ew::procGen shape and writes it as a binary mesh file (ew/meshFile.h), which ew::loadMeshFile maps and
+	uploads without generating or encoding anything at startup.
+	Also reports how long generating and encoding took, compared to mapping the written file and reading it back.
+
+	Usage: mesh_writer <shape> <params...> -o <path> [options]
+		cube <size>
+		plane <width> <height> <subdivisions>
+		sphere <radius> <subdivisions>
+		cylinder <radius> <height> <subdivisions>
+		icosphere <radius> <level>
+		cubesphere <radius> <subdivisions>
+	Options:
+		--format <f>         float, packed or quantized (default float)
+		--optimize           Reorder triangles and vertices for the vertex cache before writing
+	Usage: mesh_writer --info <path>
+		Prints the header of a mesh file
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include <ew/procGen.h>
+#include <ew/meshFile.h>
+#include <ew/meshOptimize.h>
+
+struct Shape {
+	const char* name;
+	int numParams;
+};
+const Shape SHAPES[] = {
+	{ "cube", 1 },
+	{ "plane", 3 },
+	{ "sphere", 2 },
+	{ "cylinder", 3 },
+	{ "icosphere", 2 },
+	{ "cubesphere", 2 },
+};
+const char* FORMAT_NAMES[] = { "float", "packed", "quantized" };
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void generate(const char* shape, const float* p, ew::MeshData* meshData) {
+	if (!strcmp(shape, "cube"))
+		ew::createCube(p[0], meshData);
+	else if (!strcmp(shape, "plane"))
+		ew::createPlane(p[0], p[1], (int)p[2], meshData);
+	else if (!strcmp(shape, "sphere"))
+		ew::createSphere(p[0], (int)p[1], meshData);
+	else if (!strcmp(shape, "cylinder"))
+		ew::createCylinder(p[0], p[1], (int)p[2], meshData);
+	else if (!strcmp(shape, "icosphere"))
+		ew::createIcosphere(p[0], (int)p[1], meshData);
+	else
+		ew::createCubeSphere(p[0], (int)p[1], meshData);
+}
+
+static int printInfo(const char* path) {
+	ew::MeshFile file;
+	if (!file.open(path))
+		return 1;
+	const ew::MeshFileHeader& header = file.getHeader();
+	const ew::MeshBounds& bounds = header.bounds;
+	printf("%s: version %u, %zu bytes\n", path, header.version, file.getSize());
+	printf("format     %s (%u byte vertices)\n", FORMAT_NAMES[header.vertexFormat], header.layout.stride);
+	printf("vertices   %llu at offset %llu\n", (unsigned long long)header.numVertices, (unsigned long long)header.vertexOffset);
+	printf("indices    %llu x %u bytes at offset %llu\n", (unsigned long long)header.numIndices, header.indexSize, (unsigned long long)header.indexOffset);
+	printf("box        (%g, %g, %g) - (%g, %g, %g)\n", bounds.box.min.x, bounds.box.min.y, bounds.box.min.z, bounds.box.max.x, bounds.box.max.y, bounds.box.max.z);
+	printf("sphere     (%g, %g, %g) radius %g\n", bounds.sphere.center.x, bounds.sphere.center.y, bounds.sphere.center.z, bounds.sphere.radius);
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc == 3 && !strcmp(argv[1], "--info"))
+		return printInfo(argv[2]);
+	if (argc < 2) {
+		printf("Usage: mesh_writer <shape> <params...> -o <path> [--format float|packed|quantized] [--optimize]\n");
+		return 2;
+	}
+
+	const Shape* shape = nullptr;
+	for (const Shape& s : SHAPES)
+	{
+		if (!strcmp(argv[1], s.name))
+			shape = &s;
+	}
+	if (!shape) {
+		printf("Unknown shape %s\n", argv[1]);
+		return 2;
+	}
+	if (argc < 2 + shape->numParams) {
+		printf("%s needs %d parameters\n", shape->name, shape->numParams);
+		return 2;
+	}
+	float params[3] = {};
+	for (int i = 0; i < shape->numParams; i++)
+	{
+		params[i] = (float)atof(argv[2 + i]);
+	}
+
+	const char* outPath = nullptr;
+	ew::VertexFormat vertexFormat = ew::VertexFormat::FLOAT;
+	bool optimize = false;
+	for (int i = 2 + shape->numParams; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-o") && i + 1 < argc)
+			outPath = argv[++i];
+		else if (!strcmp(argv[i], "--format") && i + 1 < argc) {
+			const char* name = argv[++i];
+			int format = 0;
+			while (format < 3 && strcmp(name, FORMAT_NAMES[format]))
+				format++;
+			if (format == 3) {
+				printf("Unknown format %s\n", name);
+				return 2;
+			}
+			vertexFormat = (ew::VertexFormat)format;
+		}
+		else if (!strcmp(argv[i], "--optimize"))
+			optimize = true;
+		else {
+			printf("Unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	if (!outPath) {
+		printf("No output path, use -o <path>\n");
+		return 2;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	ew::MeshData meshData;
+	generate(shape->name, params, &meshData);
+	if (optimize) {
+		ew::optimizeVertexCache(&meshData);
+		ew::optimizeVertexFetch(&meshData);
+	}
+	const double generateMs = msSince(start);
+
+	start = std::chrono::steady_clock::now();
+	if (!ew::writeMeshFile(outPath, meshData, vertexFormat))
+		return 1;
+	const double writeMs = msSince(start);
+
+	//Map the file and touch every page, which is what loading it costs before the GPU copy
+	start = std::chrono::steady_clock::now();
+	ew::MeshFile file;
+	if (!file.open(outPath))
+		return 1;
+	const unsigned char* bytes = (const unsigned char*)file.getData();
+	unsigned int checksum = 0;
+	for (size_t i = 0; i < file.getSize(); i += 4096)
+	{
+		checksum += bytes[i];
+	}
+	const double readMs = msSince(start);
+
+	printf("Wrote %s: %zu vertices, %zu triangles, %s, %zu bytes\n", outPath, meshData.vertices.size(), meshData.getNumIndices() / 3,
+		FORMAT_NAMES[(int)vertexFormat], file.getSize());
+	printf("generate %.2f ms, encode + write %.2f ms, map + read %.2f ms (checksum %u)\n", generateMs, writeMs, readMs, checksum);
+	return 0;
+}